@@ -0,0 +1,82 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <cstdint>
+
+
+/// The phase of a blend effect, advanced by the elapsed time.
+///
+/// The phase is kept as a fixed point value with 16 fractional bits, so
+/// the animation runs at the same speed for every frame rate. The speed
+/// is given in phase steps per reference period of 50 milliseconds.
+///
+class BlendPhase
+{
+public:
+    /// The reference period for the speed in microseconds.
+    ///
+    static constexpr uint32_t cReferencePeriod = 50000;
+
+public:
+    /// Create a new phase at zero, without speed.
+    ///
+    BlendPhase()
+        : _phase(0), _speed(0) {
+    }
+
+public:
+    /// Reset the phase to zero.
+    ///
+    inline void reset() {
+        _phase = 0;
+    }
+
+    /// Set the speed.
+    ///
+    /// @param speed The phase steps per reference period.
+    ///
+    inline void setSpeed(uint8_t speed) {
+        _speed = speed;
+    }
+
+    /// Get the current phase.
+    ///
+    inline uint8_t getPhase() const {
+        return static_cast<uint8_t>(_phase >> 16);
+    }
+
+    /// Advance the phase by the elapsed time.
+    ///
+    /// @param elapsed The elapsed time in microseconds.
+    /// @return `true` if the phase wrapped around and the blend is complete.
+    ///
+    inline bool advance(uint32_t elapsed) {
+        const uint64_t delta = (static_cast<uint64_t>(_speed) * elapsed * 0x10000u) / cReferencePeriod;
+        const uint64_t newPhase = static_cast<uint64_t>(_phase) + delta;
+        _phase = static_cast<uint32_t>(newPhase & 0xffffffu);
+        return newPhase > 0xffffffu;
+    }
+
+private:
+    uint32_t _phase; ///< The phase with 16 fractional bits.
+    uint8_t _speed; ///< The speed in phase steps per reference period.
+};
+
+
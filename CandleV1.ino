@@ -17,14 +17,27 @@
 //
 
 
+#include "BlendPhase.hpp"
 #include "Color.hpp"
+#include "ColorOutput.hpp"
+#include "CpuClock.hpp"
 #include "DS3231.hpp"
+#include "FrameBuffer.hpp"
+#include "FrameScheduler.hpp"
+#include "PaletteFrameBuffer.hpp"
+#include "Random.hpp"
+#include "Schedule.hpp"
+#include "SolarTable.hpp"
+#include "SystemClock.hpp"
+#include "TimeZone.hpp"
+#include "WireBus.hpp"
 
 #include <Wire.h>
 #include <Adafruit_NeoPixel.h>
 #include <Adafruit_DotStar.h>
 
 #include <cstdint>
+#include <type_traits>
 
 
 // Configuration
@@ -33,12 +46,101 @@
 
 /// The number of gPixels
 ///
-const uint8_t cNumberOfPixels = 24;
+const uint16_t cNumberOfPixels = 24;
+
+/// The time between two frames in milliseconds.
+///
+/// This only changes the smoothness of the effect, not its speed.
+///
+const uint32_t cFramePeriod = 50;
+
+/// The time between two checks in milliseconds, while the decoration is disabled.
+///
+const uint32_t cIdlePeriod = 1000;
+
+/// The longest time between two checks of the RTC in milliseconds.
+///
+/// The time is checked exactly at the next change of the schedule, but at
+/// least this often.
+///
+const uint32_t cMaximumTimeCheckInterval = 3600000;
+
+/// The interval in milliseconds to synchronize the system clock with the RTC.
+///
+/// Between the synchronizations, the time is extrapolated with the CPU clock.
+/// The drift of the CPU clock is measured and corrected.
+///
+const uint32_t cClockSynchronizationInterval = 21600000;
+
+/// The delay in milliseconds before a failed RTC read for the system clock is retried.
+///
+/// The delay doubles with each failed read, up to `cMaximumTimeRequestRetryDelay`.
+///
+const uint32_t cTimeRequestRetryDelay = 1000;
+
+/// The longest delay in milliseconds between two failed RTC reads for the system clock.
+///
+const uint32_t cMaximumTimeRequestRetryDelay = 60000;
+
+/// The pin connected to the INT/SQW output of the RTC, or -1 if it is not connected.
+///
+/// With this connection, the RTC alarm signals the next change of the schedule
+/// and the firmware does not have to read the time until then. On the Trinket M0,
+/// pin 1 is free for this connection. If the alarm is missed, the time is still
+/// checked shortly after the expected alarm.
+///
+const int8_t cRtcInterruptPin = -1;
+
+/// The location of the decoration for the sunrise and sunset times.
+///
+/// The latitude and longitude are in hundredths of a degree, the offset of the
+/// local standard time to UTC is in minutes.
+///
+typedef lr::SolarTable<4737, 854, 60> LocalSolarTable;
+
+/// The time zone of the decoration.
+///
+/// The RTC keeps UTC, the schedule uses the local time. The standard offset
+/// is in minutes and has to match the offset of the solar table.
+///
+/// Older versions of this firmware kept the local time in the RTC. After an
+/// update, set the RTC once again, see `setup()`.
+///
+typedef lr::TimeZoneTable<60, lr::DaylightSavingRule::European> LocalTimeZoneTable;
+
+/// The rules when the decoration is on.
+///
+/// Modify these rules to setup your on and off times for the decoration.
+/// Later rules override earlier ones. If no rule matches, the decoration is off.
+///
+const lr::ScheduleRule cScheduleRules[] = {
+    // Every evening from 19:00 until midnight.
+    {lr::ScheduleRule::cEveryDay, 101, 1231, lr::ScheduleRule::time(19), lr::ScheduleRule::time(24), lr::ScheduleRule::Action::On},
+    // Every morning from 6:00 until 8:00.
+    {lr::ScheduleRule::cEveryDay, 101, 1231, lr::ScheduleRule::time(6), lr::ScheduleRule::time(8), lr::ScheduleRule::Action::On},
+    // Example: From sunset until 23:00.
+    //{lr::ScheduleRule::cEveryDay, 101, 1231, lr::ScheduleRule::cSunset, lr::ScheduleRule::time(23), lr::ScheduleRule::Action::On},
+    // Example: Friday and Saturday nights from 22:00 until 2:00 the next morning.
+    //{lr::ScheduleRule::cFriday|lr::ScheduleRule::cSaturday, 101, 1231, lr::ScheduleRule::time(22), lr::ScheduleRule::time(2), lr::ScheduleRule::Action::On},
+};
+
+/// The order of the color channels of the used pixels.
+///
+const PixelOrder cPixelOrder = PixelOrder::GRBW;
 
 /// The pin for the data output.
 ///
 const uint8_t cDataPin = 4;
 
+/// The global brightness of the decoration, from 0 to 255.
+///
+const uint8_t cBrightness = 255;
+
+/// The gamma curve for the used LEDs in hundredths, e.g. 280 for 2.8.
+///
+const uint16_t cGammaCurve = 280;
+
+
 
 // Hardware Access.
 // --------------------------------------------------------------------------
@@ -46,49 +148,110 @@ const uint8_t cDataPin = 4;
 
 /// The global object to access the NeoPixels
 ///
-Adafruit_NeoPixel gPixels = Adafruit_NeoPixel(cNumberOfPixels, cDataPin, NEO_GRBW + NEO_KHZ800);
+Adafruit_NeoPixel gPixels = Adafruit_NeoPixel(cNumberOfPixels, cDataPin,
+    PixelOrderTraits<cPixelOrder>::cNeoPixelType + NEO_KHZ800);
+
+/// The I2C bus with the RTC.
+///
+lr::WireBus gRtcBus(Wire);
 
 /// Access to the dot star LED on the board.
 ///
 Adafruit_DotStar gDotStar(1, 7, 8, DOTSTAR_BRG);
 
+/// The output stage with the brightness and gamma correction.
+///
+ColorOutput gOutput(GammaTable<cGammaCurve, 8>::cValues);
+
 
 // Global Variables
 // --------------------------------------------------------------------------
 
 
-/// The base colors for the effect.
+/// The frame buffer for the effect.
 ///
-Color gBaseColors[cNumberOfPixels];
-
-/// The blend colors to mix with the base colors.
+/// For large installations, the palette based frame buffer uses less memory.
 ///
-Color gBlendColors[cNumberOfPixels];
+typedef std::conditional<(cNumberOfPixels > 340),
+    PaletteFrameBuffer<cNumberOfPixels>,
+    FrameBuffer<cNumberOfPixels>>::type EffectFrameBuffer;
 
-/// The begin for random color blends.
+/// The base and blend colors for the effect.
 ///
-Color gRandomBegin;
+EffectFrameBuffer gFrameBuffer;
 
-/// The end for random color blends.
+/// The random number generator for the effect.
 ///
-Color gRandomEnd;
+Random gRandom;
 
 /// The current phase for the random effect.
 ///
-uint8_t gRandomPhase = 0;
+BlendPhase gRandomPhase;
+
+/// The scheduler for the frames.
+///
+FrameScheduler<CpuClock> gFrameScheduler(cIdlePeriod * 1000);
 
-/// The current speed for the phase of the random effect..
+/// The time zone to convert the UTC time from the RTC into local time.
 ///
-uint8_t gRandomSpeed = 0;
+lr::TimeZone gTimeZone(LocalTimeZoneTable::cStandardOffset, LocalTimeZoneTable::cTransitions, LocalTimeZoneTable::cTransitionCount);
+
+/// The system clock, which keeps the UTC time between the reads of the RTC.
+///
+lr::SystemClock gSystemClock;
+
+/// The buffer for the time registers read from the RTC.
+///
+uint8_t gTimeRegisters[lr::DS3231::cDateTimeRegisterCount];
+
+/// Forward declaration of the callback for the time request.
+///
+void onTimeRead(lr::RegisterRequest &request);
+
+/// The request to read the time from the RTC after a frame, see `loop()`.
+///
+lr::RegisterRequest gTimeRequest(lr::RegisterRequest::Type::Read,
+    static_cast<uint8_t>(lr::DS3231::Register::Seconds), gTimeRegisters,
+    lr::DS3231::cDateTimeRegisterCount, onTimeRead);
+
+/// The value of `millis()` when the last time request failed.
+///
+uint32_t gTimeRequestFailTime = 0;
+
+/// The delay before the time request is submitted again, zero after a successful read.
+///
+uint32_t gTimeRequestRetryDelay = 0;
+
+/// The schedule for the decoration.
+///
+lr::Schedule gSchedule(cScheduleRules, sizeof(cScheduleRules)/sizeof(lr::ScheduleRule));
 
 /// The next point in time to check the RTC.
 ///
 uint32_t gNextTimeCheck;
 
+/// Flag if the RTC alarm was triggered, set from the interrupt.
+///
+volatile bool gRtcAlarm = false;
+
 /// Flag if the decoration is currently enabled.
 ///
 bool gIsEnabled = false;
 
+/// The buffer for a line received from the serial interface.
+///
+char gSerialLine[lr::DateTime::getStringLength(lr::DateTime::Format::ISO) + 1];
+
+/// The number of characters in the serial line buffer.
+///
+uint8_t gSerialLineLength = 0;
+
+/// If the current serial line did not fit into the buffer.
+///
+/// The whole line is rejected, so a valid prefix followed by garbage is never parsed.
+///
+bool gSerialLineOverflow = false;
+
 
 // Functions
 // --------------------------------------------------------------------------
@@ -96,13 +259,13 @@ bool gIsEnabled = false;
 
 /// Update the neopixels with the current colors and phase.
 ///
+/// The frame is only sent to the pixels if it changed.
+///
 void updateNeoPixels()
 {
-    for (int i = 0; i < cNumberOfPixels; ++i) {
-        const Color result = gBaseColors[i].mix(gBlendColors[i], gRandomPhase);
-        gPixels.setPixelColor(i, result.getValue());
+    if (gFrameBuffer.render<cPixelOrder>(gOutput, gRandomPhase.getPhase(), gPixels.getPixels())) {
+        gPixels.show();
     }
-    gPixels.show();
 }
 
 
@@ -110,68 +273,163 @@ void updateNeoPixels()
 ///
 void disableNeoPixels()
 {
-    for (int i = 0; i < cNumberOfPixels; ++i) {
+    for (uint16_t i = 0; i < cNumberOfPixels; ++i) {
         gPixels.setPixelColor(i, 0);
     }    
     gPixels.show();
 }
 
 
-/// Fill the base colors with one solid color.
+/// Generate a new random blend with the current colors.
 ///
-void fillWithColor(const Color &color)
+void generateNewRandomBlend()
 {
-    for (int i = 0; i < cNumberOfPixels; ++i) {
-        gBaseColors[i] = color;
-    }
+    gFrameBuffer.fillTargetPositions(gRandom);
+    gRandomPhase.setSpeed((gRandom.nextByte() >> 3) + 8);
 }
 
 
-/// A very simple pseudo random number generator.
-/// 
-uint8_t getSimpleRandom()
+/// Set the new random blend colors.
+///
+void setRandomBlendColors(Color a, Color b)
 {
-    static uint16_t seed = 70;
-    seed = 181 * seed + 359;
-    return (uint8_t)(seed >> 8);
+    gFrameBuffer.setGradient(a, b);
+    gRandomPhase.reset();
+    gRandomPhase.setSpeed(16);
+    gFrameBuffer.clearBase();
+    generateNewRandomBlend(); 
 }
 
 
-/// Generate a new random blend with the current colors.
+/// Check if the decoration should be on.
 ///
-void generateNewRandomBlend()
+/// Modify the rules in `cScheduleRules` to setup your on and off times for the decoration.
+///
+/// @param nextCheckDelay Set to the time in milliseconds until the next check is required.
+///
+bool isOnTime(uint32_t &nextCheckDelay)
 {
-    for (int i = 0; i < cNumberOfPixels; ++i) {
-        gBlendColors[i] = gRandomBegin.mix(gRandomEnd, getSimpleRandom());
+    // Without the RTC interrupt, only the first time is read directly, later reads
+    // are deferred to the end of a frame. These are blocking reads, which happen once
+    // per schedule change, not in every frame. The RTC alarm marks the exact second of a change,
+    // but the extrapolated time can still be before it. So with the interrupt, the
+    // RTC is read directly for each check.
+    const uint32_t milliseconds = millis();
+    bool isRtcTime = false;
+    if (!gSystemClock.isSynchronized() || cRtcInterruptPin >= 0) {
+        uint8_t registers[lr::DS3231::cDateTimeRegisterCount];
+        isRtcTime = lr::DS3231::readRegister(lr::DS3231::Register::Seconds, registers, sizeof(registers));
+        if (isRtcTime) {
+            gSystemClock.synchronize(lr::DS3231::convertDateTime(registers), milliseconds);
+        }
+    }
+    const auto utc = gSystemClock.getDateTime(milliseconds);
+    const auto now = gTimeZone.toLocal(utc);
+    lr::DateTime::StringBuffer<lr::DateTime::Format::ISO> text;
+    now.toChars(text);
+    Serial.println(text.data);
+    // Check again at the next change of the schedule or of the time zone.
+    const uint32_t utcSeconds = utc.toSecondsSince2000();
+    uint32_t nextCheck = gTimeZone.toUtcAfter(gSchedule.nextTransition(now), utc).toSecondsSince2000();
+    const uint32_t nextTimeZoneTransition = gTimeZone.getNextTransition(utc);
+    if (nextTimeZoneTransition < nextCheck) {
+        nextCheck = nextTimeZoneTransition;
     }
-    gRandomSpeed = (getSimpleRandom() >> 3) + 8;
+    if (nextCheck <= utcSeconds || nextCheck - utcSeconds >= cMaximumTimeCheckInterval / 1000) {
+        nextCheckDelay = cMaximumTimeCheckInterval;
+    } else {
+        nextCheckDelay = (nextCheck - utcSeconds) * 1000;
+    }
+    // The alarm is always at least one second after the current second of the RTC,
+    // an alarm for a second which already matched would never trigger. If the RTC
+    // could not be read, the check time in `loop()` is used instead.
+    if (cRtcInterruptPin >= 0 && isRtcTime) {
+        lr::DS3231::setAlarm(utc.addSeconds(nextCheckDelay / 1000));
+    }
+    return gSchedule.isOn(now);
 }
 
 
-/// Set the new random blend colors.
+/// Synchronize the system clock after the time was read in the background.
 ///
-void setRandomBlendColors(Color a, Color b)
+/// If the read failed, the next request is delayed with a growing delay.
+///
+void onTimeRead(lr::RegisterRequest &request)
 {
-    gRandomBegin = a;
-    gRandomEnd = b;
-    gRandomPhase = 0;
-    gRandomSpeed = 16;
-    fillWithColor(Color());
-    generateNewRandomBlend(); 
+    if (request.state == lr::RegisterRequest::State::Done) {
+        gSystemClock.synchronize(lr::DS3231::convertDateTime(gTimeRegisters), millis());
+        gTimeRequestRetryDelay = 0;
+    } else {
+        // Do not block the bus in every frame, while the RTC does not respond.
+        gTimeRequestFailTime = millis();
+        if (gTimeRequestRetryDelay == 0) {
+            gTimeRequestRetryDelay = cTimeRequestRetryDelay;
+        } else if (gTimeRequestRetryDelay < cMaximumTimeRequestRetryDelay / 2) {
+            gTimeRequestRetryDelay *= 2;
+        } else {
+            gTimeRequestRetryDelay = cMaximumTimeRequestRetryDelay;
+        }
+    }
 }
 
 
-/// Check if the decoration should be on.
+/// Read a new date/time from the serial interface and set the RTC.
 ///
-/// Modify this function to setup your on and off times for the decoration.
+/// Send the local date/time in the format `yyyy-MM-ddThh:mm:ss`, followed by a newline.
+/// It is converted into UTC for the RTC. Lines longer than the buffer are rejected.
 ///
-bool isOnTime()
+void checkSerialInput()
 {
-    auto now = lr::DS3231::getDateTime();
-    Serial.println(now.toString(lr::DateTime::Format::ISO));
-    auto hour = now.getHour();
-    
-    return (hour >= 19) || (hour > 5 && hour < 8);
+    while (Serial.available() > 0) {
+        const char c = static_cast<char>(Serial.read());
+        if (c == '\n' || c == '\r') {
+            if (gSerialLineOverflow) {
+                Serial.println("ERROR");
+            } else if (gSerialLineLength > 0) {
+                lr::DateTime dateTime;
+                bool success = false;
+                if (dateTime.parse(gSerialLine, gSerialLineLength, lr::DateTime::Format::ISO) == lr::DateTime::ParseResult::Success) {
+                    const auto utc = gTimeZone.toUtc(dateTime);
+                    success = lr::DS3231::setDateTime(utc);
+                    if (success) {
+                        gSystemClock.synchronize(utc, millis());
+                        gNextTimeCheck = millis(); // Check the new time immediately.
+                        gRtcAlarm = true;
+                    }
+                }
+                Serial.println(success ? "OK" : "ERROR");
+            }
+            gSerialLineLength = 0;
+            gSerialLineOverflow = false;
+        } else if (gSerialLineLength < sizeof(gSerialLine)) {
+            gSerialLine[gSerialLineLength++] = c;
+        } else {
+            gSerialLineOverflow = true;
+        }
+    }
+}
+
+
+/// Check if the time has to be checked.
+///
+/// With the RTC interrupt, this reads the flag which is set by the alarm.
+/// The I2C bus is not used. The next check time is still compared, as
+/// fallback if the alarm is missed.
+///
+bool isTimeCheckRequired()
+{
+    if (cRtcInterruptPin >= 0 && gRtcAlarm) {
+        return true;
+    }
+    return static_cast<int32_t>(gNextTimeCheck - millis()) < 0;
+}
+
+
+/// The interrupt handler for the RTC alarm.
+///
+void onRtcAlarm()
+{
+    gRtcAlarm = true;
 }
 
 
@@ -193,20 +451,23 @@ void setup()
     delay(1000);
     
     // Initialise the RTC driver.
-    lr::DS3231::initialize();
+    lr::DS3231::initialize(gRtcBus);
 
-    // Uncomment this line and set the current date/time to set the RTC once.
+    // To set the RTC, send the current local date/time as `yyyy-MM-ddThh:mm:ss` over the serial interface.
+    // Alternatively, uncomment this line and set the current UTC date/time to set the RTC once.
     // Make sure to comment it out and re-upload the firmware after setting the RTC!
     //lr::DS3231::setDateTime(lr::DateTime(2020,1,1,20,0,0));
     
     // Check if the RTC is running and had no time issues.
     if (!lr::DS3231::isRunning()) {
         // Do not start the decoration if the RTC does not has the correct time.
-        while(1) {
+        // Wait until the time is set using the serial interface.
+        while(!lr::DS3231::isRunning()) {
             digitalWrite(LED_BUILTIN, HIGH);
             delay(200);
             digitalWrite(LED_BUILTIN, LOW);
             delay(400);
+            checkSerialInput();
         }
     }
 
@@ -215,6 +476,16 @@ void setup()
     gDotStar.setPixelColor(0, 0);
     gDotStar.show();
     
+    // Set the sunrise and sunset times for the schedule.
+    gSchedule.setSolarTable(LocalSolarTable::cSunrise, LocalSolarTable::cSunset);
+    gSchedule.setTimeZone(&gTimeZone);
+
+    // Set the interval to read the time from the RTC.
+    gSystemClock.setSynchronizationInterval(cClockSynchronizationInterval);
+
+    // Set the global brightness.
+    gOutput.setBrightness(cBrightness);
+
     // Initialise the NeoPixels driver.
     gPixels.begin();
     gPixels.clear();
@@ -223,8 +494,18 @@ void setup()
     // Set the colors for the random effect.
     setRandomBlendColors(Color(0x6200), Color(0x0024));
 
+    // Connect the alarm output of the RTC. It is an open drain output and low if triggered.
+    if (cRtcInterruptPin >= 0) {
+        pinMode(cRtcInterruptPin, INPUT_PULLUP);
+        attachInterrupt(digitalPinToInterrupt(cRtcInterruptPin), onRtcAlarm, FALLING);
+    } else {
+        lr::DS3231::clearAlarm();
+    }
+
     // Make the first time check after one second after start.
     gNextTimeCheck = millis() + 1000;
+    gRtcAlarm = true;
+    gFrameScheduler.start();
 }
 
 
@@ -232,30 +513,46 @@ void setup()
 ///
 void loop()
 {
-    // Check the RTC every minute and enable/disable the decoration.
-    if (static_cast<int32_t>(gNextTimeCheck - millis()) < 0) {
-        gNextTimeCheck = millis() + 60000; // Check every minute.
-        bool onTime = isOnTime();
+    // Check for a new date/time from the serial interface.
+    checkSerialInput();
+
+    // Check the RTC at the next change of the schedule and enable/disable the decoration.
+    if (isTimeCheckRequired()) {
+        gRtcAlarm = false;
+        uint32_t nextCheckDelay;
+        bool onTime = isOnTime(nextCheckDelay);
+        // With the RTC interrupt, the check time is a fallback shortly after the alarm.
+        gNextTimeCheck = millis() + nextCheckDelay + (cRtcInterruptPin >= 0 ? 1000 : 0);
         if (gIsEnabled != onTime) {
             gIsEnabled = onTime;
-            if (!gIsEnabled) {
+            if (gIsEnabled) {
+                gFrameScheduler.setFramePeriod(cFramePeriod * 1000);
+                gFrameScheduler.start();
+            } else {
+                gFrameScheduler.setFramePeriod(cIdlePeriod * 1000);
                 disableNeoPixels();
             }
         }
     }        
 
+    // Read the RTC after the frame, if the system clock needs a synchronization.
+    if (gSystemClock.isSynchronizationRequired(millis()) && millis() - gTimeRequestFailTime >= gTimeRequestRetryDelay) {
+        lr::DS3231::submitRequest(gTimeRequest);
+    }
+
     // If the decoration is enabled, produce a random effect.
     if (gIsEnabled) {
         updateNeoPixels();
-        delay(50);
-        const uint8_t oldPhase = gRandomPhase;
-        gRandomPhase += gRandomSpeed;
-        if (oldPhase > gRandomPhase) {
-            for (uint8_t i = 0; i < cNumberOfPixels; ++i) {
-                gBaseColors[i] = gBlendColors[i];
-            }
-            generateNewRandomBlend();
-        }    
+    }
+
+    // Transfer the RTC requests after the frame is sent.
+    lr::DS3231::processRequests();
+
+    // Sleep for the rest of the frame.
+    const uint32_t elapsed = gFrameScheduler.waitForNextFrame();
+    if (gIsEnabled && gRandomPhase.advance(elapsed)) {
+        gFrameBuffer.commitTarget();
+        generateNewRandomBlend();
     }
 }
 
@@ -18,14 +18,21 @@
 //
 
 
+#include "GammaTable.hpp"
+
 #include <Arduino.h>
 
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 
 /// A color class to simplify calculations.
 ///
-class Color
+/// The color is aligned to 4 bytes, so `getRaw()` reads all channels with
+/// a single word access, also on cores without unaligned access.
+///
+class alignas(4) Color
 {
 public:
     /// Create black color.
@@ -61,6 +68,37 @@ public:
         return Color(newR, newG, newB, newW);
     }
     
+    /// Mix two spans of colors into packed 32bit values.
+    ///
+    /// This produces exactly the same result as calling `mix()` for each pair
+    /// of colors, but processes two channels with one multiplication.
+    ///
+    /// @param a The colors for phase zero.
+    /// @param b The colors to blend in.
+    /// @param shift The blend amount, 0 = only `a`.
+    /// @param out The output buffer for the packed colors, see `getRaw()`.
+    /// @param count The number of colors to mix.
+    ///
+    inline static void mixSpan(const Color *a, const Color *b, uint8_t shift, uint32_t *out, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = mixRaw(a[i].getRaw(), b[i].getRaw(), shift);
+        }
+    }
+
+    /// Mix two packed colors.
+    ///
+    /// The channels are split into two words with 16bit lanes. The largest
+    /// lane value is 255*256, so the sum can never carry into the next lane.
+    ///
+    inline static uint32_t mixRaw(uint32_t a, uint32_t b, uint8_t shift) {
+        const uint32_t cLaneMask = 0x00ff00ffu;
+        const uint32_t aShift = 0x100-(uint32_t)shift;
+        const uint32_t bShift = shift;
+        const uint32_t evenChannels = ((((a & cLaneMask) * aShift) + ((b & cLaneMask) * bShift)) >> 8) & cLaneMask;
+        const uint32_t oddChannels = ((((a >> 8) & cLaneMask) * aShift) + (((b >> 8) & cLaneMask) * bShift)) & ~cLaneMask;
+        return evenChannels | oddChannels;
+    }
+
     /// Set the brightness
     ///
     inline Color dim(uint8_t level) const {
@@ -83,7 +121,30 @@ public:
         return result;
     }
 
-public:    
+    /// Get the packed 32bit value of this color.
+    ///
+    /// The layout is r = bits 0-7, g = bits 8-15, b = bits 16-23 and w = bits 24-31.
+    /// This is no output value, use `getValue()` for the NeoPixel library.
+    ///
+    inline uint32_t getRaw() const {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        uint32_t raw;
+        memcpy(&raw, this, sizeof(raw));
+        return raw;
+#else
+        return (uint32_t)r | ((uint32_t)g << 8) | ((uint32_t)b << 16) | ((uint32_t)w << 24);
+#endif
+    }
+
+public:
+    /// Create a color from a packed 32bit value.
+    ///
+    /// @see getRaw()
+    ///
+    inline static Color fromRaw(uint32_t raw) {
+        return Color((uint8_t)raw, (uint8_t)(raw >> 8), (uint8_t)(raw >> 16), (uint8_t)(raw >> 24));
+    }
+
     /// Get a color value. color = 0-191
     ///
     inline static Color wheel(uint8_t color, uint8_t white) {
@@ -112,9 +173,13 @@ public:
     }
 
 public:
+    /// The default gamma curve in hundredths.
+    ///
+    static constexpr uint16_t cDefaultGamma = 280;
+
     /// Gamme correction table.
     ///
-    static const uint8_t cGamma[];
+    static constexpr const uint8_t *cGamma = GammaTable<cDefaultGamma, 8>::cValues;
     
 public:
     uint8_t r; ///< The red amount.
@@ -123,4 +188,6 @@ public:
     uint8_t w; ///< The white amount.
 };
 
+static_assert(sizeof(Color) == 4, "The color has to be packed into 32 bits.");
+
 
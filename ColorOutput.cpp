@@ -0,0 +1,50 @@
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "ColorOutput.hpp"
+
+
+ColorOutput::ColorOutput(const uint8_t *gammaTable)
+    : _gammaTable(gammaTable), _brightness(0xff)
+{
+    updateTable();
+}
+
+
+void ColorOutput::setBrightness(uint8_t level)
+{
+    if (_brightness != level) {
+        _brightness = level;
+        updateTable();
+    }
+}
+
+
+uint8_t ColorOutput::getBrightness() const
+{
+    return _brightness;
+}
+
+
+void ColorOutput::updateTable()
+{
+    // Use the same scaling as Color::dim(), full brightness keeps the values unchanged.
+    const uint16_t level16 = (uint16_t)_brightness+1;
+    for (uint16_t i = 0; i < 0x100; ++i) {
+        _table[i] = _gammaTable[(i * level16)/0x100];
+    }
+}
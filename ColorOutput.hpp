@@ -0,0 +1,102 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "Color.hpp"
+#include "PixelOrder.hpp"
+
+#include <cstdint>
+
+
+/// The output stage which converts colors into values for the NeoPixel library.
+///
+/// The global brightness and the gamma correction are combined into one
+/// lookup table, which is only rebuilt if the brightness changes. Converting
+/// a color costs four table lookups, independent of the brightness.
+///
+class ColorOutput
+{
+public:
+    /// Create a new output stage with full brightness.
+    ///
+    /// @param gammaTable The 8bit gamma table to use, see `GammaTable`.
+    ///
+    explicit ColorOutput(const uint8_t *gammaTable = Color::cGamma);
+
+public:
+    /// Set the global brightness.
+    ///
+    /// This rebuilds the lookup table if the level changes.
+    ///
+    /// @param level The brightness from 0 = off to 255 = full brightness.
+    ///
+    void setBrightness(uint8_t level);
+
+    /// Get the global brightness.
+    ///
+    uint8_t getBrightness() const;
+
+    /// Write a single packed color in wire order.
+    ///
+    /// The bytes are written directly into the pixel buffer of the NeoPixel
+    /// library. Its own brightness scaling is bypassed, use `setBrightness()`.
+    /// For strips without white channel, the white value is ignored.
+    ///
+    /// While writing, the new bytes are compared with the previous content
+    /// of the buffer, so unchanged frames are detected without an extra pass.
+    ///
+    /// @tparam tOrder The pixel order of the strip.
+    /// @param raw The packed color, see `Color::getRaw()`.
+    /// @param pixelOut The location of the pixel in the pixel buffer.
+    /// @param difference Bits which differ from the previous bytes are set in this value.
+    /// @return The location of the next pixel.
+    ///
+    template<PixelOrder tOrder>
+    inline uint8_t* writePixel(uint32_t raw, uint8_t *pixelOut, uint8_t &difference) const {
+        typedef PixelOrderTraits<tOrder> Traits;
+        difference |= writeByte(pixelOut[Traits::cRedOffset], _table[(uint8_t)raw]);
+        difference |= writeByte(pixelOut[Traits::cGreenOffset], _table[(uint8_t)(raw >> 8)]);
+        difference |= writeByte(pixelOut[Traits::cBlueOffset], _table[(uint8_t)(raw >> 16)]);
+        if (Traits::cChannelCount == 4) {
+            difference |= writeByte(pixelOut[Traits::cWhiteOffset], _table[(uint8_t)(raw >> 24)]);
+        }
+        return pixelOut + Traits::cChannelCount;
+    }
+
+private:
+    /// Write a byte and return the bits which changed.
+    ///
+    inline static uint8_t writeByte(uint8_t &target, uint8_t value) {
+        const uint8_t difference = target ^ value;
+        target = value;
+        return difference;
+    }
+
+private:
+    /// Rebuild the lookup table for the current brightness.
+    ///
+    void updateTable();
+
+private:
+    const uint8_t *_gammaTable; ///< The gamma correction table.
+    uint8_t _brightness; ///< The current brightness.
+    uint8_t _table[256]; ///< The combined brightness and gamma table.
+};
+
+
@@ -0,0 +1,214 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <cstdint>
+
+
+/// @namespace lr::ConstMath
+///
+/// Math functions which are evaluated by the compiler.
+///
+/// These functions are used to generate lookup tables at compile time.
+/// They are written for C++11 `constexpr` rules and are far too slow to be
+/// used at runtime.
+
+
+namespace lr {
+namespace ConstMath {
+
+
+/// @internal
+/// The natural logarithm of two.
+///
+constexpr double cLn2 = 0.693147180559945309417;
+
+/// @internal
+/// The sum of the series `2*(z + z^3/3 + z^5/5 + ...)` for the logarithm.
+///
+constexpr double lnSeries(double z, double z2, double power, uint8_t n)
+{
+    return n > 61 ? 0.0 : (2.0 * power / n) + lnSeries(z, z2, power * z2, n + 2);
+}
+
+/// @internal
+/// The sum of the taylor series for the exponential function.
+///
+constexpr double expSeries(double x, double term, uint8_t n)
+{
+    return n > 24 ? term : term + expSeries(x, term * x / n, n + 1);
+}
+
+/// @internal
+/// Square a value.
+///
+constexpr double square(double x)
+{
+    return x * x;
+}
+
+/// The natural logarithm.
+///
+/// @param x A value greater than zero.
+///
+constexpr double ln(double x)
+{
+    return x < 0.5 ? ln(x * 2.0) - cLn2 :
+        (x >= 1.0 ? ln(x / 2.0) + cLn2 :
+        lnSeries((x - 1.0) / (x + 1.0), square((x - 1.0) / (x + 1.0)), (x - 1.0) / (x + 1.0), 1));
+}
+
+/// The exponential function.
+///
+constexpr double exp(double x)
+{
+    return (x > 0.5 || x < -0.5) ? square(exp(x / 2.0)) : expSeries(x, 1.0, 1);
+}
+
+/// Raise a positive value to the given power.
+///
+/// @param x The base, zero or greater.
+/// @param y The exponent.
+///
+constexpr double pow(double x, double y)
+{
+    return x <= 0.0 ? 0.0 : exp(y * ln(x));
+}
+
+/// @internal
+/// Pi.
+///
+constexpr double cPi = 3.14159265358979323846;
+
+/// @internal
+/// The sum of the taylor series for the sine.
+///
+constexpr double sinSeries(double x2, double term, uint8_t n)
+{
+    return n > 41 ? term : term + sinSeries(x2, -term * x2 / ((n + 1.0) * (n + 2.0)), n + 2);
+}
+
+/// Round a value down to the next integer.
+///
+constexpr double floor(double x)
+{
+    return static_cast<double>(static_cast<int64_t>(x)) > x ?
+        static_cast<double>(static_cast<int64_t>(x)) - 1.0 : static_cast<double>(static_cast<int64_t>(x));
+}
+
+/// Wrap an angle in radians into the range -pi to pi.
+///
+constexpr double wrapAngle(double x)
+{
+    return x - 2.0 * cPi * floor((x + cPi) / (2.0 * cPi));
+}
+
+/// The sine of an angle in radians.
+///
+constexpr double sin(double x)
+{
+    return sinSeries(square(wrapAngle(x)), wrapAngle(x), 1);
+}
+
+/// The cosine of an angle in radians.
+///
+constexpr double cos(double x)
+{
+    return sin(x + cPi / 2.0);
+}
+
+/// The tangent of an angle in radians.
+///
+constexpr double tan(double x)
+{
+    return sin(x) / cos(x);
+}
+
+/// @internal
+/// Newton iterations for the square root.
+///
+constexpr double sqrtIteration(double x, double guess, uint8_t n)
+{
+    return n == 0 ? guess : sqrtIteration(x, 0.5 * (guess + x / guess), n - 1);
+}
+
+/// The square root.
+///
+constexpr double sqrt(double x)
+{
+    return x <= 0.0 ? 0.0 : sqrtIteration(x, x > 1.0 ? x : 1.0, 48);
+}
+
+/// @internal
+/// The sum of the taylor series for the arc tangent.
+///
+constexpr double atanSeries(double x2, double power, uint8_t n)
+{
+    return n > 41 ? 0.0 : (((n / 2) % 2 == 0 ? power : -power) / n) + atanSeries(x2, power * x2, n + 2);
+}
+
+/// The arc tangent in radians.
+///
+constexpr double atan(double x)
+{
+    return x < 0.0 ? -atan(-x) :
+        (x > 1.0 ? cPi / 2.0 - atan(1.0 / x) :
+        (x > 0.25 ? 2.0 * atan(x / (1.0 + sqrt(1.0 + x * x))) :
+        atanSeries(x * x, x, 1)));
+}
+
+/// The arc cosine in radians.
+///
+/// Values outside of the range -1 to 1 are limited to this range.
+///
+constexpr double acos(double x)
+{
+    return x >= 1.0 ? 0.0 : (x <= -1.0 ? cPi : 2.0 * atan(sqrt((1.0 - x) / (1.0 + x))));
+}
+
+/// Round a positive value to the nearest integer.
+///
+constexpr uint32_t round(double x)
+{
+    return static_cast<uint32_t>(x + 0.5);
+}
+
+
+/// A list of indexes to expand table initializers.
+///
+template<uint16_t... tIndex>
+struct IndexList {
+};
+
+/// Create a index list `0, 1, ..., tCount-1` as `Type`.
+///
+template<uint16_t tCount, uint16_t... tIndex>
+struct MakeIndexList : MakeIndexList<tCount-1, tCount-1, tIndex...> {
+};
+
+template<uint16_t... tIndex>
+struct MakeIndexList<0, tIndex...> {
+    typedef IndexList<tIndex...> Type;
+};
+
+
+}
+}
+
+
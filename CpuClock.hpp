@@ -0,0 +1,50 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <Arduino.h>
+
+#include <cstdint>
+
+
+/// The clock of the microcontroller for the `FrameScheduler`.
+///
+struct CpuClock
+{
+    /// Get the current time in microseconds.
+    ///
+    inline static uint32_t getTime() {
+        return micros();
+    }
+
+    /// Sleep until the next interrupt.
+    ///
+    /// The core stays in idle mode, so the system tick wakes it up every
+    /// millisecond and `millis()` and `micros()` keep running.
+    ///
+    inline static void waitForInterrupt() {
+#if defined(ARDUINO_ARCH_SAMD)
+        __WFI();
+#else
+        yield();
+#endif
+    }
+};
+
+
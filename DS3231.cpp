@@ -18,13 +18,20 @@
 #include "DS3231.hpp"
 
 
-#include <Wire.h>
+#include "RequestQueue.hpp"
+
+#include <cstring>
 
 
 namespace lr {
 namespace DS3231 {
 
 
+constexpr uint8_t RegisterSnapshot::cRegisterCount;
+constexpr uint8_t RegisterSnapshot::cFormatVersion;
+constexpr uint8_t RegisterSnapshot::cSerializedSize;
+
+
 /// @internal
 /// A struct to store all time related registers in one block.
 ///
@@ -38,6 +45,16 @@ struct DateTimeRegister {
     uint8_t year;
 };
 
+/// @internal
+/// A struct with the registers of alarm 1.
+///
+struct AlarmRegister {
+    uint8_t seconds;
+    uint8_t minutes;
+    uint8_t hours;
+    uint8_t dayDate;
+};
+
 /// @internal
 /// A struct with the temperature registers.
 ///
@@ -52,11 +69,65 @@ struct TemperatureRegister {
 ///
 static const uint8_t cChipAddress = 0x68;
 
+/// @internal
+/// The mask bit in the alarm registers.
+///
+static const uint8_t cAlarmMaskBit = (1<<7);
+
+/// @internal
+/// The bit in the alarm day/date register to select the day of the week.
+///
+static const uint8_t cAlarmDayOfWeekBit = (1<<6);
+
+/// @internal
+/// The first register of the shadow copy.
+///
+static const uint8_t cShadowFirst = static_cast<uint8_t>(Register::Alarm1Seconds);
+
+/// @internal
+/// The number of registers in the shadow copy, the alarms, control and status.
+///
+static const uint8_t cShadowCount = static_cast<uint8_t>(Register::Status) - cShadowFirst + 1;
+
+/// @internal
+/// The status flags which are set by the chip and can only be cleared.
+///
+/// Writing a one to these flags has no effect, so the shadow copy keeps them
+/// set, unless they shall be cleared.
+///
+static const uint8_t cStatusClearFlags = static_cast<uint8_t>(Status::A1F) |
+    static_cast<uint8_t>(Status::A2F) | static_cast<uint8_t>(Status::OSF);
+
 /// @internal
 /// The year base.
 ///
 static uint16_t gYearBase;
 
+/// @internal
+/// The bus to access the chip.
+///
+static I2cBus *gBus = nullptr;
+
+/// @internal
+/// The shadow copy of the alarm, control and status registers.
+///
+static uint8_t gShadow[cShadowCount];
+
+/// @internal
+/// A bit mask with the changed registers in the shadow copy.
+///
+static uint16_t gShadowDirty = 0;
+
+/// @internal
+/// Flag if the shadow copy was read from the chip.
+///
+static bool gShadowLoaded = false;
+
+/// @internal
+/// The queue with the pending requests.
+///
+static RequestQueue<cRequestQueueSize> gRequestQueue;
+
 
 /// @internal
 /// Function to convert BCD format into binary format.
@@ -76,30 +147,131 @@ static inline uint8_t convertBinToBcd(const uint8_t bin)
 }
 
 
+/// @internal
+/// Function to convert the day of the week into the chip format.
+///
+/// The chip counts the day of the week from 1 to 7, so Sunday is stored as 7.
+///
+static inline uint8_t convertDayOfWeekToChip(const uint8_t dayOfWeek)
+{
+    return (dayOfWeek == 0) ? 7 : dayOfWeek;
+}
+
+
+/// @internal
+/// Convert the values of the time registers into a date/time, for the given year base.
+///
+static DateTime convertDateTime(const uint8_t *registers, uint16_t yearBase)
+{
+    const DateTimeRegister &data = *reinterpret_cast<const DateTimeRegister*>(registers);
+    // Convert these values into a date object.
+    return DateTime::fromUncheckedValues(
+        static_cast<uint16_t>(convertBcdToBin(data.year))+((data.month&(1<<7))!=0?(yearBase+100):yearBase),
+        convertBcdToBin(data.month&0x1f),
+        convertBcdToBin(data.day&0x3f),
+        convertBcdToBin(data.hours&0x3f),
+        convertBcdToBin(data.minutes&0x7f),
+        convertBcdToBin(data.seconds&0x7f),
+        (data.dayOfWeek&0x7)%7);
+}
+
+
+/// @internal
+/// Convert the values of alarm registers.
+///
+/// @param registers The alarm registers, starting with the seconds.
+/// @param skip The number of registers to skip, 1 for alarm 2 without seconds.
+///
+static AlarmValues convertAlarm(const uint8_t *registers, uint8_t skip)
+{
+    // The first register with a set mask bit defines the mode.
+    uint8_t firstMasked = skip;
+    while (firstMasked < 4 && (registers[firstMasked] & cAlarmMaskBit) == 0) {
+        ++firstMasked;
+    }
+    const uint8_t dayDate = registers[3];
+    AlarmValues result;
+    result.second = (skip == 0) ? convertBcdToBin(registers[0] & 0x7f) : 0;
+    result.minute = convertBcdToBin(registers[1] & 0x7f);
+    result.hour = convertBcdToBin(registers[2] & 0x3f);
+    if ((dayDate & cAlarmDayOfWeekBit) != 0) {
+        result.dayDate = (dayDate & 0x7) % 7;
+    } else {
+        result.dayDate = convertBcdToBin(dayDate & 0x3f);
+    }
+    if (firstMasked < 4) {
+        result.mode = static_cast<AlarmMode>(firstMasked);
+    } else if ((dayDate & cAlarmDayOfWeekBit) != 0) {
+        result.mode = AlarmMode::DayOfWeekHourMinuteSecond;
+    } else {
+        result.mode = AlarmMode::DateHourMinuteSecond;
+    }
+    return result;
+}
+
+
+/// @internal
+/// Check if a register is part of the shadow copy.
+///
+static inline bool isShadowRegister(uint8_t reg)
+{
+    return reg >= cShadowFirst && reg < (cShadowFirst + cShadowCount);
+}
+
+
+/// @internal
+/// Update the shadow copy after registers were written to the chip.
+///
+static void updateShadowRegisters(uint8_t reg, const uint8_t *values, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; ++i, ++reg) {
+        if (isShadowRegister(reg)) {
+            const uint8_t index = reg - cShadowFirst;
+            uint8_t value = values[i];
+            if (reg == static_cast<uint8_t>(Register::Control)) {
+                value &= ~static_cast<uint8_t>(Control::CONV); // Cleared by the chip.
+            } else if (reg == static_cast<uint8_t>(Register::Status)) {
+                value |= cStatusClearFlags;
+            }
+            gShadow[index] = value;
+            gShadowDirty &= ~(1u << index);
+        }
+    }
+}
+
+
+/// @internal
+/// Read the shadow copy from the chip, if this wasn't done yet.
+///
+/// @return `true` if the shadow copy is loaded.
+///
+static bool loadShadowRegisters()
+{
+    if (!gShadowLoaded) {
+        uint8_t values[cShadowCount];
+        if (!readRegister(static_cast<Register>(cShadowFirst), values, cShadowCount)) {
+            return false;
+        }
+        updateShadowRegisters(cShadowFirst, values, cShadowCount);
+        gShadowLoaded = true;
+    }
+    return true;
+}
+
+
 uint8_t readRegister(Register reg)
 {
-    // Address the register
-    Wire.beginTransmission(cChipAddress);
-    Wire.write(static_cast<uint8_t>(reg));
-    Wire.endTransmission();
-    // Read one byte from the register.
-    Wire.requestFrom(cChipAddress, 1u);
-    const uint8_t data = Wire.read();
+    uint8_t data;
+    if (!readRegister(reg, &data, 1)) {
+        return 0xff;
+    }
     return data;
 }
 
 
-void readRegister(Register reg, uint8_t *valueOut, uint8_t count)
+bool readRegister(Register reg, uint8_t *valueOut, uint8_t count)
 {
-    // Address the register
-    Wire.beginTransmission(cChipAddress);
-    Wire.write(static_cast<uint8_t>(reg));
-    Wire.endTransmission();
-    // Read the register values
-    Wire.requestFrom(cChipAddress, count);
-    for (uint8_t i = 0; i < count; ++i) {
-        valueOut[i] = Wire.read();
-    }
+    return gBus->readRegisters(cChipAddress, static_cast<uint8_t>(reg), valueOut, count);
 }
 
 
@@ -109,67 +281,91 @@ bool readFlag(Register reg, uint8_t bitMask)
 }
 
 
-void writeRegister(Register reg, uint8_t value)
+bool writeRegister(Register reg, uint8_t value)
 {
-    // Address the register and write the value
-    Wire.beginTransmission(cChipAddress);
-    Wire.write(static_cast<uint8_t>(reg));
-    Wire.write(value);
-    Wire.endTransmission();
+    return writeRegister(reg, &value, 1);
 }
 
 
-void writeRegister(Register reg, const uint8_t *valueIn, uint8_t count)
+bool writeRegister(Register reg, const uint8_t *valueIn, uint8_t count)
 {
-    // Address the register and write the values
-    Wire.beginTransmission(cChipAddress);
-    Wire.write(static_cast<uint8_t>(reg));
-    for (uint8_t i = 0; i < count; ++i) {
-        Wire.write(valueIn[i]);
+    if (!gBus->writeRegisters(cChipAddress, static_cast<uint8_t>(reg), valueIn, count)) {
+        return false;
     }
-    Wire.endTransmission();
+    updateShadowRegisters(static_cast<uint8_t>(reg), valueIn, count);
+    return true;
 }
 
 
-void writeRegister(Register reg, uint8_t value, uint8_t mask)
+bool writeRegister(Register reg, uint8_t value, uint8_t mask)
 {
     value &= mask; // Remove not maked bits.
-    uint8_t data = readRegister(reg); // Read the old value.
+    if (isShadowRegister(static_cast<uint8_t>(reg))) {
+        // Only change the shadow copy, and mark the register if the value changes.
+        if (!loadShadowRegisters()) {
+            return false;
+        }
+        const uint8_t index = static_cast<uint8_t>(reg) - cShadowFirst;
+        const uint8_t data = (gShadow[index] & (~mask)) | value;
+        if (data != gShadow[index]) {
+            gShadow[index] = data;
+            gShadowDirty |= (1u << index);
+        }
+        return true;
+    }
+    uint8_t data;
+    if (!readRegister(reg, &data, 1)) { // Read the old value.
+        return false;
+    }
     data &= (~mask); // Remove the masked bits.
     data |= value; // Add the new value.
-    writeRegister(reg, data); // Write the combined value.
+    return writeRegister(reg, data); // Write the combined value.
 }
 
 
-void setFlag(Register reg, uint8_t bitMask)
+bool setFlag(Register reg, uint8_t bitMask)
 {
-    uint8_t data = readRegister(reg); // Read the old value.
-    data |= bitMask; // Set the flag.
-    writeRegister(reg, data); // Write the combined value.
+    return writeRegister(reg, bitMask, bitMask);
 }
 
 
-void clearFlag(Register reg, uint8_t bitMask)
+bool clearFlag(Register reg, uint8_t bitMask)
 {
-    uint8_t data = readRegister(reg); // Read the old value.
-    data &= (~bitMask); // Clear the flag
-    writeRegister(reg, data); // Write the combined value.
+    return writeRegister(reg, static_cast<uint8_t>(0), bitMask);
 }
 
 
-void writeFlag(Register reg, uint8_t bitMask, bool enabled)
+bool writeFlag(Register reg, uint8_t bitMask, bool enabled)
 {
-    if (enabled) {
-        setFlag(reg, bitMask);
-    } else {
-        clearFlag(reg, bitMask);
+    return writeRegister(reg, enabled ? bitMask : 0, bitMask);
+}
+
+
+bool commit()
+{
+    if (gShadowDirty == 0) {
+        return true;
+    }
+    // Write all registers from the first to the last change in one burst.
+    uint8_t first = 0;
+    while ((gShadowDirty & (1u << first)) == 0) {
+        ++first;
     }
+    uint8_t last = cShadowCount - 1;
+    while ((gShadowDirty & (1u << last)) == 0) {
+        --last;
+    }
+    // The changed registers stay marked if the write fails, so the next commit retries.
+    return writeRegister(static_cast<Register>(cShadowFirst + first), gShadow + first, last - first + 1);
 }
 
 
-void initialize(uint16_t yearBase)
+void initialize(I2cBus &bus, uint16_t yearBase)
 {
+    gBus = &bus;
     gYearBase = yearBase;
+    gShadowLoaded = false;
+    gShadowDirty = 0;
 }
 
 
@@ -178,24 +374,16 @@ DateTime getDateTime()
     // Use the struct to read all registers in one batch.
     DateTimeRegister data;
     readRegister(Register::Seconds, reinterpret_cast<uint8_t*>(&data), sizeof(DateTimeRegister));
-    // Convert these values into a date object.
-    return DateTime::fromUncheckedValues(
-        static_cast<uint16_t>(convertBcdToBin(data.year))+((data.month&(1<<7))!=0?(gYearBase+100):gYearBase),
-        convertBcdToBin(data.month&0x1f),
-        convertBcdToBin(data.day&0x3f),
-        convertBcdToBin(data.hours&0x3f),
-        convertBcdToBin(data.minutes&0x7f),
-        convertBcdToBin(data.seconds&0x7f),
-        data.dayOfWeek&0x7);
+    return convertDateTime(reinterpret_cast<const uint8_t*>(&data));
 }
 
 
-void setDateTime(const DateTime &dateTime)
+bool setDateTime(const DateTime &dateTime)
 {
     // Basic year check
     const uint16_t newYear = dateTime.getYear();
     if (newYear < gYearBase || newYear >= (gYearBase+200)) {
-        return; // Ignore this call.
+        return false; // Ignore this call.
     }
     // Use a struct to write all registers in one batch.
     DateTimeRegister data;
@@ -203,22 +391,29 @@ void setDateTime(const DateTime &dateTime)
     data.seconds = convertBinToBcd(dateTime.getSecond());
     data.minutes = convertBinToBcd(dateTime.getMinute());
     data.hours = convertBinToBcd(dateTime.getHour());
-    data.dayOfWeek = dateTime.getDayOfWeek();
+    data.dayOfWeek = convertDayOfWeekToChip(dateTime.getDayOfWeek());
     data.day = convertBinToBcd(dateTime.getDay());
     data.month = convertBinToBcd(dateTime.getMonth()) |
         (dateTime.getYear()>=(gYearBase+100)?(1<<7):0);
     data.year = convertBinToBcd(dateTime.getYear()%100);
     // Write all registers.
-    writeRegister(Register::Seconds, reinterpret_cast<uint8_t*>(&data), sizeof(DateTimeRegister));
+    if (!writeRegister(Register::Seconds, reinterpret_cast<uint8_t*>(&data), sizeof(DateTimeRegister))) {
+        return false;
+    }
     // Enable the clock, start the oscillator and reset any status flags.
-    writeRegister(Register::Control, 0b00000000u);
-    writeRegister(Register::Status, 0);
+    return writeRegister(Register::Control, static_cast<uint8_t>(0b00000000u), 0xff)
+        && writeRegister(Register::Status, static_cast<uint8_t>(0), 0xff)
+        && commit();
 }
 
 
 bool isRunning()
 {
-    return !readFlag(Status::OSF);
+    uint8_t status;
+    if (!readRegister(Register::Status, &status, 1)) {
+        return false;
+    }
+    return (status & static_cast<uint8_t>(Status::OSF)) == 0;
 }
 
 
@@ -227,6 +422,98 @@ float getTemperature()
     // Read the temperature.
     TemperatureRegister data;
     readRegister(Register::TemperatureHigh, reinterpret_cast<uint8_t*>(&data), sizeof(TemperatureRegister));
+    return convertTemperature(reinterpret_cast<const uint8_t*>(&data));
+}
+
+
+bool setAlarm(const DateTime &dateTime, AlarmMode mode)
+{
+    // Prepare the values, each mask bit excludes a value from the match.
+    AlarmRegister data;
+    data.seconds = convertBinToBcd(dateTime.getSecond());
+    if (mode == AlarmMode::EverySecond) {
+        data.seconds |= cAlarmMaskBit;
+    }
+    data.minutes = convertBinToBcd(dateTime.getMinute());
+    if (mode < AlarmMode::MinuteSecond) {
+        data.minutes |= cAlarmMaskBit;
+    }
+    data.hours = convertBinToBcd(dateTime.getHour());
+    if (mode < AlarmMode::HourMinuteSecond) {
+        data.hours |= cAlarmMaskBit;
+    }
+    if (mode == AlarmMode::DayOfWeekHourMinuteSecond) {
+        data.dayDate = convertDayOfWeekToChip(dateTime.getDayOfWeek()) | cAlarmDayOfWeekBit;
+    } else {
+        data.dayDate = convertBinToBcd(dateTime.getDay());
+        if (mode < AlarmMode::DateHourMinuteSecond) {
+            data.dayDate |= cAlarmMaskBit;
+        }
+    }
+    // Change the registers, clear a previous alarm and enable the interrupt.
+    const uint8_t *values = reinterpret_cast<const uint8_t*>(&data);
+    for (uint8_t i = 0; i < sizeof(AlarmRegister); ++i) {
+        if (!writeRegister(static_cast<Register>(static_cast<uint8_t>(Register::Alarm1Seconds) + i), values[i], 0xff)) {
+            return false;
+        }
+    }
+    if (!clearFlag(Status::A1F)) {
+        return false;
+    }
+    const uint8_t interruptFlags = static_cast<uint8_t>(Control::INTCN) | static_cast<uint8_t>(Control::A1IE);
+    if (!writeRegister(Register::Control, interruptFlags, interruptFlags)) {
+        return false;
+    }
+    // Write all changes in one burst.
+    return commit();
+}
+
+
+bool clearAlarm()
+{
+    return clearFlag(Control::A1IE) && clearFlag(Status::A1F) && commit();
+}
+
+
+bool alarmFired()
+{
+    return readFlag(Status::A1F);
+}
+
+
+bool submitRequest(RegisterRequest &request)
+{
+    return gRequestQueue.submit(request);
+}
+
+
+bool hasPendingRequests()
+{
+    return !gRequestQueue.isEmpty();
+}
+
+
+void processRequests()
+{
+    while (gRequestQueue.processNext([](RegisterRequest &request) {
+        if (request.type == RegisterRequest::Type::Read) {
+            return readRegister(static_cast<Register>(request.firstRegister), request.data, request.count);
+        }
+        return writeRegister(static_cast<Register>(request.firstRegister), request.data, request.count);
+    })) {
+    }
+}
+
+
+DateTime convertDateTime(const uint8_t *registers)
+{
+    return convertDateTime(registers, gYearBase);
+}
+
+
+float convertTemperature(const uint8_t *registers)
+{
+    const TemperatureRegister &data = *reinterpret_cast<const TemperatureRegister*>(registers);
     // Create a float from this values.
     float result = static_cast<float>(data.high);
     const float fraction = static_cast<float>(data.low >> 6) * 0.25f;
@@ -239,29 +526,112 @@ float getTemperature()
 }
 
 
-void printAllRegisterValues()
+bool printAllRegisterValues()
 {
-    const uint8_t rtcRegisterCount = 0x13;
-    uint8_t rtcRegister[rtcRegisterCount];
-    readRegister(Register::Seconds, rtcRegister, rtcRegisterCount);
-    for (uint8_t i = 0; i < rtcRegisterCount; ++i) {
-        if (i < 0x10) {
-           Serial.print('0');
-        }
-        Serial.print(i, HEX);
-        Serial.print(':');
-        const uint8_t value = rtcRegister[i];
+    RegisterSnapshot snapshot;
+    if (!readSnapshot(snapshot)) {
+        Serial.println("Failed to read the registers.");
+        return false;
+    }
+    // Format each line as `rr:bbbbbbbb:vv` and write it at once.
+    const char cHexDigits[] = "0123456789ABCDEF";
+    char line[15];
+    line[2] = ':';
+    line[11] = ':';
+    line[14] = '\0';
+    for (uint8_t i = 0; i < RegisterSnapshot::cRegisterCount; ++i) {
+        const uint8_t value = snapshot.registers[i];
+        line[0] = cHexDigits[i >> 4];
+        line[1] = cHexDigits[i & 0xf];
         for (uint8_t j = 0; j < 8; ++j) {
-            Serial.print(((value&(1<<(7-j)))!=0)?'1':'0');
+            line[3+j] = ((value&(1<<(7-j)))!=0)?'1':'0';
         }
-        Serial.print(':');
-        if (value < 0x10) {
-           Serial.print('0');
-        }
-        Serial.println(value, HEX);
+        line[12] = cHexDigits[value >> 4];
+        line[13] = cHexDigits[value & 0xf];
+        Serial.println(line);
     }
+    return true;
 }
 
 
+bool readSnapshot(RegisterSnapshot &snapshot)
+{
+    snapshot.yearBase = gYearBase;
+    return readRegister(Register::Seconds, snapshot.registers, RegisterSnapshot::cRegisterCount);
+}
+
+
+uint8_t RegisterSnapshot::getRegister(Register reg) const
+{
+    return registers[static_cast<uint8_t>(reg)];
+}
+
+
+DateTime RegisterSnapshot::getDateTime() const
+{
+    return convertDateTime(registers, yearBase);
+}
+
+
+AlarmValues RegisterSnapshot::getAlarm1() const
+{
+    return convertAlarm(registers + static_cast<uint8_t>(Register::Alarm1Seconds), 0);
+}
+
+
+AlarmValues RegisterSnapshot::getAlarm2() const
+{
+    // Alarm 2 has no seconds register, so it triggers at second zero.
+    return convertAlarm(registers + static_cast<uint8_t>(Register::Alarm2Minutes) - 1, 1);
+}
+
+
+bool RegisterSnapshot::isFlagSet(Control flag) const
+{
+    return (getRegister(Register::Control) & static_cast<uint8_t>(flag)) != 0;
+}
+
+
+bool RegisterSnapshot::isFlagSet(Status flag) const
+{
+    return (getRegister(Register::Status) & static_cast<uint8_t>(flag)) != 0;
+}
+
+
+int8_t RegisterSnapshot::getAgingOffset() const
+{
+    return static_cast<int8_t>(getRegister(Register::AgingOffset));
+}
+
+
+float RegisterSnapshot::getTemperature() const
+{
+    return convertTemperature(registers + static_cast<uint8_t>(Register::TemperatureHigh));
+}
+
+
+uint8_t RegisterSnapshot::serialize(uint8_t *out, uint8_t capacity) const
+{
+    if (capacity < cSerializedSize) {
+        return 0;
+    }
+    out[0] = cFormatVersion;
+    out[1] = static_cast<uint8_t>(yearBase);
+    out[2] = static_cast<uint8_t>(yearBase >> 8);
+    memcpy(out + 3, registers, cRegisterCount);
+    return cSerializedSize;
+}
+
+
+bool RegisterSnapshot::deserialize(const uint8_t *in, uint8_t size)
+{
+    if (size != cSerializedSize || in[0] != cFormatVersion) {
+        return false;
+    }
+    yearBase = static_cast<uint16_t>(in[1]) | (static_cast<uint16_t>(in[2]) << 8);
+    memcpy(registers, in + 3, cRegisterCount);
+    return true;
+}
+
 }
 }
@@ -20,6 +20,8 @@
 
 
 #include "DateTime.hpp"
+#include "I2cBus.hpp"
+#include "RegisterRequest.hpp"
 
 
 /// @namespace lr::DS3231
@@ -36,12 +38,13 @@ namespace DS3231 {
 
 /// Initialize the real time clock driver.
 ///
+/// @param bus The I2C bus with the chip, e.g. a `WireBus`. It has to exist as long as the driver is used.
 /// @param yearBase The year base which is used for the RTC. The RTC stores the year
 ///    only with two digits, plus one additional bit for the next century. If you set
 //     the year base to `2000`, the RTC will hold the correct time for 200 years,
 ///    starting from `2000-01-01 00:00:00`.
 ///
-void initialize(uint16_t yearBase = 2000);
+void initialize(I2cBus &bus, uint16_t yearBase = 2000);
 
 /// Get the current date/time.
 ///
@@ -49,16 +52,52 @@ DateTime getDateTime();
 
 /// Set the date/time.
 ///
-void setDateTime(const DateTime &dateTime);
+/// @return `true` on success, `false` if the year is out of range or the write failed.
+///
+bool setDateTime(const DateTime &dateTime);
 
 /// Check if the RTC is running.
 ///
+/// @return `true` if the oscillator did not stop, `false` if it stopped or the chip does not respond.
+///
 bool isRunning();
 
 /// Get the temperature in degrees celsius.
 ///
 float getTemperature();
 
+/// The values which have to match to trigger the alarm.
+///
+enum class AlarmMode : uint8_t {
+    EverySecond, ///< Trigger the alarm every second.
+    Second, ///< Trigger if the second matches.
+    MinuteSecond, ///< Trigger if the minute and second match.
+    HourMinuteSecond, ///< Trigger if the hour, minute and second match.
+    DateHourMinuteSecond, ///< Trigger if the day of the month, hour, minute and second match.
+    DayOfWeekHourMinuteSecond, ///< Trigger if the day of the week, hour, minute and second match.
+};
+
+/// Set the alarm and enable the interrupt output.
+///
+/// This uses alarm 1 of the chip. The INT/SQW output goes low if the
+/// alarm triggers and stays low until the alarm is cleared or set again.
+///
+/// @param dateTime The date/time for the alarm. Only the values which are part of the mode are used.
+/// @param mode The values which have to match.
+/// @return `true` on success, `false` if the write failed.
+///
+bool setAlarm(const DateTime &dateTime, AlarmMode mode = AlarmMode::DateHourMinuteSecond);
+
+/// Disable the alarm and clear the alarm flag.
+///
+/// @return `true` on success, `false` if the write failed.
+///
+bool clearAlarm();
+
+/// Check if the alarm was triggered.
+///
+bool alarmFired();
+
 /// @name Low Level Functions
 /// Low level functions to directly access all registers of the chip or
 /// to print useful information for debugging.
@@ -66,7 +105,12 @@ float getTemperature();
 
 /// Print the status of all register values.
 ///
-void printAllRegisterValues();
+/// The registers are read with one burst read into a `RegisterSnapshot`.
+/// If the read fails, an error message is printed instead.
+///
+/// @return `true` on success, `false` if the read failed.
+///
+bool printAllRegisterValues();
 
 /// All registers available in the chip.
 ///
@@ -118,7 +162,7 @@ enum class Status : uint8_t {
 /// Read a single register from the chip.
 ///
 /// @param reg The register to read.
-/// @return The value from the register.
+/// @return The value from the register, or 0xff if the read failed, like from an idle bus.
 ///
 uint8_t readRegister(Register reg);
 
@@ -127,14 +171,20 @@ uint8_t readRegister(Register reg);
 /// @param reg The first register to read.
 /// @param valueOut An array of bytes to write the register values to.
 /// @param count The number of registers to read.
+/// @return `true` on success, `false` if the transfer failed.
 ///
-void readRegister(Register reg, uint8_t *valueOut, uint8_t count);
+bool readRegister(Register reg, uint8_t *valueOut, uint8_t count);
 
 /// Read a flag from a register.
 ///
+/// The flag is always read from the chip. Changes of the alarm, control and
+/// status registers, which are only in the shadow copy, are not visible until
+/// they are written with `commit()`. The high level functions, like
+/// `setAlarm()` and `clearAlarm()`, commit their changes before they return.
+///
 /// @param reg The register for the flag.
 /// @param bitMask The bit mask for the flag.
-/// @return true if the flag is set.
+/// @return true if the flag is set, or if the read failed.
 ///
 bool readFlag(Register reg, uint8_t bitMask);
 
@@ -142,62 +192,243 @@ bool readFlag(Register reg, uint8_t bitMask);
 ///
 /// @param reg The register to write into.
 /// @param value The new value.
+/// @return `true` on success, `false` if the transfer failed.
 ///
-void writeRegister(Register reg, uint8_t value);
+bool writeRegister(Register reg, uint8_t value);
 
 /// Write a multiple register values to the chip.
 ///
 /// @param reg The start register for the write.
 /// @param valueIn A pointer to the array of values to write.
 /// @param count The number of registers to write.
+/// @return `true` on success, `false` if the transfer failed.
 ///
-void writeRegister(Register reg, const uint8_t *valueIn, uint8_t count);
+bool writeRegister(Register reg, const uint8_t *valueIn, uint8_t count);
 
 /// Write a few bits in a single register.
 ///
-/// This reads the register first, masks the result and writes the register.
+/// For the alarm, control and status registers, only the shadow copy is changed
+/// and the change is written with the next `commit()`. All other registers are
+/// read first, masked and written back.
 ///
 /// @param reg The register to write into.
 /// @param value The new value.
 /// @param mask The mask. Each 1 bit in the mask set is written.
+/// @return `true` on success, `false` if a transfer failed.
 ///
-void writeRegister(Register reg, uint8_t value, uint8_t mask);
+bool writeRegister(Register reg, uint8_t value, uint8_t mask);
 
 /// Write a flag to a register.
 ///
 /// This will only do a write to the chip if the flag changes.
+/// See `writeRegister(Register, uint8_t, uint8_t)` for the shadow copy.
 ///
 /// @param reg The register to change.
 /// @param bitMask The bit mask for the flag.
 /// @param enabled If the flag should be set `true` or cleared `false`.
+/// @return `true` on success, `false` if a transfer failed.
 ///
-void writeFlag(Register reg, uint8_t bitMask, bool enabled);
+bool writeFlag(Register reg, uint8_t bitMask, bool enabled);
 
 /// Set a flag in a register.
 ///
+/// See `writeRegister(Register, uint8_t, uint8_t)` for the shadow copy.
+///
 /// @param reg The register to change.
 /// @param bitMask The bit mask for the flag.
+/// @return `true` on success, `false` if a transfer failed.
 ///
-void setFlag(Register reg, uint8_t bitMask);
+bool setFlag(Register reg, uint8_t bitMask);
 
 /// Clear a flag in a register.
 ///
+/// See `writeRegister(Register, uint8_t, uint8_t)` for the shadow copy.
+///
 /// @param reg The register to change.
 /// @param bitMask The bit mask for the flag.
+/// @return `true` on success, `false` if a transfer failed.
+///
+bool clearFlag(Register reg, uint8_t bitMask);
+
+/// Write all changes in the shadow copy to the chip.
+///
+/// The driver keeps a shadow copy of the alarm, control and status registers.
+/// It is read once from the chip, and all masked writes and flag changes for
+/// these registers are collected in the copy. This function writes all changed
+/// registers in one burst. If nothing changed, the bus is not used.
+///
+/// The alarm flags and the oscillator stop flag in the status register are
+/// only written as zero if they were cleared, so flags which are set by the
+/// chip in between are kept.
+///
+/// If the write fails, the changed registers are kept and written with the
+/// next call. Until then, reads from the chip still return the old values.
 ///
-void clearFlag(Register reg, uint8_t bitMask);
+/// @return `true` on success or if nothing changed, `false` if the write failed.
+///
+bool commit();
 
 
 // Helper methods to simplify the code.
 inline bool readFlag(Control flag) { return readFlag(Register::Control, static_cast<uint8_t>(flag)); }
 inline bool readFlag(Status flag) { return readFlag(Register::Status, static_cast<uint8_t>(flag)); }
-inline void setFlag(Control flag) { setFlag(Register::Control, static_cast<uint8_t>(flag)); }
-inline void setFlag(Status flag) { setFlag(Register::Status, static_cast<uint8_t>(flag)); }
-inline void clearFlag(Control flag) { clearFlag(Register::Control, static_cast<uint8_t>(flag)); }
-inline void clearFlag(Status flag) { clearFlag(Register::Status, static_cast<uint8_t>(flag)); }
-inline void writeFlag(Control flag, bool enabled) { writeFlag(Register::Control, static_cast<uint8_t>(flag), enabled); }
-inline void writeFlag(Status flag, bool enabled) { writeFlag(Register::Status, static_cast<uint8_t>(flag), enabled); }
+inline bool setFlag(Control flag) { return setFlag(Register::Control, static_cast<uint8_t>(flag)); }
+inline bool setFlag(Status flag) { return setFlag(Register::Status, static_cast<uint8_t>(flag)); }
+inline bool clearFlag(Control flag) { return clearFlag(Register::Control, static_cast<uint8_t>(flag)); }
+inline bool clearFlag(Status flag) { return clearFlag(Register::Status, static_cast<uint8_t>(flag)); }
+inline bool writeFlag(Control flag, bool enabled) { return writeFlag(Register::Control, static_cast<uint8_t>(flag), enabled); }
+inline bool writeFlag(Status flag, bool enabled) { return writeFlag(Register::Status, static_cast<uint8_t>(flag), enabled); }
+
+
+/// @}
 
+/// @name Deferred Requests
+/// Functions to defer register transfers. The requests are queued and
+/// transferred with `processRequests()`, which is called where the firmware
+/// has time for the bus transfers, e.g. after rendering a frame.
+///
+/// The Wire library of the SAMD core only has blocking transfers, so the
+/// transfers do not overlap with other work and are not driven by the I2C
+/// interrupt. The queue only moves them to a point where they do not delay
+/// the rendering.
+/// @{
+
+/// The number of time registers, starting with `Register::Seconds`.
+///
+const uint8_t cDateTimeRegisterCount = 7;
+
+/// The number of temperature registers, starting with `Register::TemperatureHigh`.
+///
+const uint8_t cTemperatureRegisterCount = 2;
+
+/// The maximum number of pending requests.
+///
+const uint8_t cRequestQueueSize = 4;
+
+/// Submit a request to read or write registers.
+///
+/// Writes to the alarm, control or status registers also update the shadow copy.
+///
+/// @param request The request. It has to exist until it is done.
+/// @return `true` on success, `false` if the queue is full or the request is already pending.
+///
+bool submitRequest(RegisterRequest &request);
+
+/// Check if there are pending requests.
+///
+bool hasPendingRequests();
+
+/// Transfer all pending requests and call their callbacks.
+///
+/// Each transfer blocks until it is complete. Call this function from the
+/// main loop, never from an interrupt.
+///
+void processRequests();
+
+/// Convert the values of the time registers into a date/time.
+///
+/// @param registers The values of the `cDateTimeRegisterCount` time registers.
+///
+DateTime convertDateTime(const uint8_t *registers);
+
+/// Convert the values of the temperature registers into degrees celsius.
+///
+/// @param registers The values of the `cTemperatureRegisterCount` temperature registers.
+///
+float convertTemperature(const uint8_t *registers);
+
+/// @}
+
+/// @name Register Snapshot
+/// A copy of all registers, to get the full state of the chip in one transfer
+/// and to decode it later, e.g. on a host for diagnostics.
+/// @{
+
+/// The values of an alarm.
+///
+struct AlarmValues {
+    uint8_t second; ///< The second, always 0 for alarm 2.
+    uint8_t minute; ///< The minute.
+    uint8_t hour; ///< The hour.
+    uint8_t dayDate; ///< The day of the month or the day of the week, 0=Sunday.
+    AlarmMode mode; ///< The values which have to match.
+};
+
+/// A copy of all registers of the chip.
+///
+struct RegisterSnapshot {
+    /// The number of registers in the chip.
+    ///
+    static constexpr uint8_t cRegisterCount = 0x13;
+
+    /// The version of the binary format.
+    ///
+    static constexpr uint8_t cFormatVersion = 1;
+
+    /// The size of the binary format: version, year base and all registers.
+    ///
+    static constexpr uint8_t cSerializedSize = 3 + cRegisterCount;
+
+    /// Get the raw value of a register.
+    ///
+    uint8_t getRegister(Register reg) const;
+
+    /// Get the date/time.
+    ///
+    DateTime getDateTime() const;
+
+    /// Get the values of alarm 1.
+    ///
+    AlarmValues getAlarm1() const;
+
+    /// Get the values of alarm 2.
+    ///
+    /// Alarm 2 has no seconds, so "every minute" is returned as `AlarmMode::Second`.
+    ///
+    AlarmValues getAlarm2() const;
+
+    /// Check a flag of the control register.
+    ///
+    bool isFlagSet(Control flag) const;
+
+    /// Check a flag of the status register.
+    ///
+    bool isFlagSet(Status flag) const;
+
+    /// Get the aging offset of the oscillator.
+    ///
+    int8_t getAgingOffset() const;
+
+    /// Get the temperature in degrees celsius.
+    ///
+    float getTemperature() const;
+
+    /// Write the snapshot in a compact binary format.
+    ///
+    /// @param out The buffer for the data.
+    /// @param capacity The size of the buffer, at least `cSerializedSize`.
+    /// @return The number of bytes written, zero if the buffer is too small.
+    ///
+    uint8_t serialize(uint8_t *out, uint8_t capacity) const;
+
+    /// Read the snapshot from the binary format.
+    ///
+    /// @param in The data written with `serialize()`.
+    /// @param size The number of bytes.
+    /// @return `true` on success, `false` if the size or version does not match.
+    ///
+    bool deserialize(const uint8_t *in, uint8_t size);
+
+    uint16_t yearBase; ///< The year base of the driver, to decode the year.
+    uint8_t registers[cRegisterCount]; ///< The values of all registers.
+};
+
+/// Read all registers of the chip in one burst.
+///
+/// @param snapshot The snapshot to fill.
+/// @return `true` on success, `false` if the read failed and the registers are undefined.
+///
+bool readSnapshot(RegisterSnapshot &snapshot);
 
 /// @}
 
@@ -42,18 +42,20 @@ static const uint16_t cSecondsPerHour = 3600;
 // The number of seconds per minute.
 static const uint16_t cSecondsPerMinute = 60;
 
-// The number of days for a regular year.
-static const uint32_t cDaysPerNormalYear = 365;
+// The layouts of all formats for the parser, in the order of the enum.
+static const char * const cParseLayouts[] = {
+    "yyyy-MM-ddThh:mm:ss",
+    "yyyy-MM-dd hh:mm:ss",
+    "yyyy-MM-dd",
+    "yyyyMMdd",
+    "hh:mm:ss",
+    "hhmmss",
+    "dd.MM.",
+    "hh:mm"};
+
+// The number of days from 0000-03-01 to 2000-01-01.
+static const uint32_t cDaysTo2000 = 730425;
 
-// Various output formats for the sprintf function.
-static const char cStringFormatISO[] = "%04d-%02d-%02dT%02d:%02d:%02d"; // yyyy-MM-ddThh:mm:ss
-static const char cStringFormatLong[] = "%04d-%02d-%02d %02d:%02d:%02d"; // yyyy-MM-dd hh:mm:ss
-static const char cStringFormatISODate[] = "%04d-%02d-%02d"; // yyyy-MM-dd
-static const char cStringFormatISOBasicDate[] = "%04d%02d%02d"; // yyyyMMdd
-static const char cStringFormatISOTime[] = "%02d:%02d:%02d"; // hh:mm:ss
-static const char cStringFormatISOBasicTime[] = "%02d%02d%02d"; // hhmmss
-static const char cStringFormatShortDate[] = "%02d.%02d."; // dd.MM.
-static const char cStringFormatShortTime[] = "%02d:%02d"; // hh:mm
 
 
 // Calculate the day of the week.
@@ -83,13 +85,80 @@ static inline uint8_t getMaxDayPerMonth(uint16_t year, uint8_t month)
 }
 
 
-static inline uint32_t getDaysForYear(uint16_t year)
+// Write a value with two digits.
+static inline char* writeTwoDigits(char *out, uint8_t value)
 {
-    if (isLeapYear(year)) {
-        return cDaysPerNormalYear + 1;
-    } else {
-        return cDaysPerNormalYear;
+    out[0] = '0' + (value / 10);
+    out[1] = '0' + (value % 10);
+    return out + 2;
+}
+
+
+// Write a value with four digits.
+static inline char* writeFourDigits(char *out, uint16_t value)
+{
+    out = writeTwoDigits(out, value / 100);
+    return writeTwoDigits(out, value % 100);
+}
+
+
+// Write the date in the format yyyy-MM-dd, with an optional separator.
+static inline char* writeDate(char *out, uint16_t year, uint8_t month, uint8_t day, char separator)
+{
+    out = writeFourDigits(out, year);
+    if (separator != '\0') {
+        *out++ = separator;
+    }
+    out = writeTwoDigits(out, month);
+    if (separator != '\0') {
+        *out++ = separator;
     }
+    return writeTwoDigits(out, day);
+}
+
+
+// Write the time in the format hh:mm:ss, with an optional separator.
+static inline char* writeTime(char *out, uint8_t hour, uint8_t minute, uint8_t second, char separator)
+{
+    out = writeTwoDigits(out, hour);
+    if (separator != '\0') {
+        *out++ = separator;
+    }
+    out = writeTwoDigits(out, minute);
+    if (separator != '\0') {
+        *out++ = separator;
+    }
+    return writeTwoDigits(out, second);
+}
+
+
+// Calculate the number of days since 2000-01-01.
+// Using the days_from_civil algorithm from: http://howardhinnant.github.io/date_algorithms.html
+// The year is counted from March, so the leap day is the last day of the year.
+static uint32_t getDaysSince2000(uint16_t year, uint8_t month, uint8_t day)
+{
+    const uint32_t y = static_cast<uint32_t>(year) - (month <= 2 ? 1 : 0);
+    const uint32_t era = y / 400;
+    const uint32_t yearOfEra = y - era * 400; // 0-399
+    const uint32_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1; // 0-365
+    const uint32_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear; // 0-146096
+    return era * 146097 + dayOfEra - cDaysTo2000;
+}
+
+
+// Calculate the date from the number of days since 2000-01-01.
+// Using the civil_from_days algorithm from: http://howardhinnant.github.io/date_algorithms.html
+static void getDateFromDays(uint32_t daysSince2000, uint16_t &year, uint8_t &month, uint8_t &day)
+{
+    const uint32_t days = daysSince2000 + cDaysTo2000;
+    const uint32_t era = days / 146097;
+    const uint32_t dayOfEra = days - era * 146097; // 0-146096
+    const uint32_t yearOfEra = (dayOfEra - dayOfEra/1460 + dayOfEra/36524 - dayOfEra/146096) / 365; // 0-399
+    const uint32_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100); // 0-365
+    const uint32_t monthPosition = (5 * dayOfYear + 2) / 153; // 0-11, starting with March
+    day = static_cast<uint8_t>(dayOfYear - (153 * monthPosition + 2) / 5 + 1);
+    month = static_cast<uint8_t>(monthPosition < 10 ? monthPosition + 3 : monthPosition - 9);
+    year = static_cast<uint16_t>(yearOfEra + era * 400 + (month <= 2 ? 1 : 0));
 }
 
 
@@ -232,6 +301,12 @@ uint8_t DateTime::getDayOfWeek() const
 }
 
 
+uint16_t DateTime::getDayOfYear() const
+{
+    return static_cast<uint16_t>(getDaysSince2000(_year, _month, _day) - getDaysSince2000(_year, 1, 1));
+}
+
+
 uint8_t DateTime::getHour() const
 {
     return _hour;
@@ -250,14 +325,78 @@ uint8_t DateTime::getSecond() const
 }
 
 
+void DateTime::advanceSeconds(uint32_t seconds)
+{
+    const uint32_t total = static_cast<uint32_t>(_second) + seconds;
+    if (total < cSecondsPerMinute) {
+        _second = total;
+        return;
+    }
+    _second = total % cSecondsPerMinute;
+    advanceMinutes(total / cSecondsPerMinute);
+}
+
+
+void DateTime::advanceMinutes(uint32_t minutes)
+{
+    const uint32_t total = static_cast<uint32_t>(_minute) + minutes;
+    if (total < 60) {
+        _minute = total;
+        return;
+    }
+    _minute = total % 60;
+    const uint32_t hours = static_cast<uint32_t>(_hour) + (total / 60);
+    if (hours < 24) {
+        _hour = hours;
+        return;
+    }
+    _hour = hours % 24;
+    advanceDays(hours / 24);
+}
+
+
+void DateTime::advanceDays(uint32_t days)
+{
+    if (days == 0) {
+        return;
+    }
+    _dayOfWeek = (_dayOfWeek + days) % 7;
+    const uint32_t total = static_cast<uint32_t>(_day) + days;
+    const uint8_t maxDayPerMonth = getMaxDayPerMonth(_year, _month);
+    if (total <= maxDayPerMonth) {
+        _day = total;
+    } else if (total == static_cast<uint32_t>(maxDayPerMonth) + 1) {
+        _day = 1;
+        if (_month < 12) {
+            ++_month;
+        } else {
+            _month = 1;
+            ++_year;
+        }
+    } else {
+        getDateFromDays(getDaysSince2000(_year, _month, _day) + days, _year, _month, _day);
+    }
+}
+
+
 DateTime DateTime::addSeconds(int32_t seconds) const
 {
+    if (seconds >= 0) {
+        DateTime result(*this);
+        result.advanceSeconds(static_cast<uint32_t>(seconds));
+        return result;
+    }
     return fromSecondsSince2000(toSecondsSince2000() + seconds);
 }
 
 
 DateTime DateTime::addDays(int32_t days) const
 {
+    if (days >= 0) {
+        DateTime result(*this);
+        result.advanceDays(static_cast<uint32_t>(days));
+        return result;
+    }
     return fromSecondsSince2000(toSecondsSince2000() + days*cSecondsPerDay);
 }
 
@@ -270,17 +409,7 @@ int32_t DateTime::secondsTo(const DateTime &other) const
 
 uint32_t DateTime::toSecondsSince2000() const
 {
-    // This calculation will require some CPU cycles. It is an
-    // programmatic solution, no mathematical one.
-
-    uint32_t seconds = 0;
-    for (uint16_t year = 2000; year < _year; ++year) {
-        seconds += (getDaysForYear(year) * static_cast<uint32_t>(cSecondsPerDay));
-    }
-    for (uint8_t month = 1; month < _month; ++month) {
-        seconds += (static_cast<uint32_t>(getMaxDayPerMonth(_year, month)) * static_cast<uint32_t>(cSecondsPerDay));
-    }
-    seconds += static_cast<uint32_t>(_day-1) * static_cast<uint32_t>(cSecondsPerDay);
+    uint32_t seconds = getDaysSince2000(_year, _month, _day) * cSecondsPerDay;
     seconds += static_cast<uint32_t>(_hour) * static_cast<uint32_t>(cSecondsPerHour);
     seconds += static_cast<uint32_t>(_minute) * static_cast<uint32_t>(cSecondsPerMinute);
     seconds += static_cast<uint32_t>(_second);
@@ -296,43 +425,129 @@ bool DateTime::isFirst() const
 
 String DateTime::toString(Format format) const
 {
-    char buffer[32];
+    StringBuffer<Format::ISO> buffer; // The longest format.
+    toChars(buffer.data, sizeof(buffer.data), format);
+    return String(buffer.data);
+}
+
+
+size_t DateTime::toChars(char *out, size_t capacity, Format format) const
+{
+    const size_t length = getStringLength(format);
+    if (capacity <= length) {
+        return 0;
+    }
     switch (format) {
         case Format::ISO:
-            sprintf(buffer, cStringFormatISO, _year, _month, _day, _hour, _minute, _second);
+            out = writeDate(out, _year, _month, _day, '-');
+            *out++ = 'T';
+            out = writeTime(out, _hour, _minute, _second, ':');
             break;
         case Format::Long:
-            sprintf(buffer, cStringFormatLong, _year, _month, _day, _hour, _minute, _second);
+            out = writeDate(out, _year, _month, _day, '-');
+            *out++ = ' ';
+            out = writeTime(out, _hour, _minute, _second, ':');
             break;
         case Format::ISODate:
-            sprintf(buffer, cStringFormatISODate, _year, _month, _day);
+            out = writeDate(out, _year, _month, _day, '-');
             break;
         case Format::ISOBasicDate:
-            sprintf(buffer, cStringFormatISOBasicDate, _year, _month, _day);
+            out = writeDate(out, _year, _month, _day, '\0');
             break;
         case Format::ISOTime:
-            sprintf(buffer, cStringFormatISOTime, _hour, _minute, _second);
+            out = writeTime(out, _hour, _minute, _second, ':');
             break;
         case Format::ISOBasicTime:
-            sprintf(buffer, cStringFormatISOBasicTime, _hour, _minute, _second);
+            out = writeTime(out, _hour, _minute, _second, '\0');
             break;
         case Format::ShortDate:
-            sprintf(buffer, cStringFormatShortDate, _day, _month);
+            out = writeTwoDigits(out, _day);
+            *out++ = '.';
+            out = writeTwoDigits(out, _month);
+            *out++ = '.';
             break;
         case Format::ShortTime:
-            sprintf(buffer, cStringFormatShortTime, _hour, _minute);
+            out = writeTwoDigits(out, _hour);
+            *out++ = ':';
+            out = writeTwoDigits(out, _minute);
             break;
     }
-    return String(buffer);
+    *out = '\0';
+    return length;
 }
 
 
-DateTime DateTime::fromSecondsSince2000(uint32_t secondsSince2000)
+DateTime::ParseResult DateTime::parse(const char *text, size_t length, Format format)
 {
-    // This calculation will require some CPU cycles. It is an
-    // programmatic solution, no mathematical one. This function
-    // is approximate 6 times slower than mathematical implementations.
+    if (length != getStringLength(format)) {
+        return ParseResult::WrongLength;
+    }
+    const char *layout = cParseLayouts[static_cast<uint8_t>(format)];
+    // Collect the digits of all fields which are part of the format.
+    uint16_t year = 0;
+    uint16_t month = 0;
+    uint16_t day = 0;
+    uint16_t hour = 0;
+    uint16_t minute = 0;
+    uint16_t second = 0;
+    for (size_t i = 0; i < length; ++i) {
+        uint16_t *value;
+        switch (layout[i]) {
+            case 'y': value = &year; break;
+            case 'M': value = &month; break;
+            case 'd': value = &day; break;
+            case 'h': value = &hour; break;
+            case 'm': value = &minute; break;
+            case 's': value = &second; break;
+            default:
+                if (text[i] != layout[i]) {
+                    return ParseResult::InvalidCharacter;
+                }
+                continue;
+        }
+        const uint8_t digit = static_cast<uint8_t>(text[i] - '0');
+        if (digit > 9) {
+            return ParseResult::InvalidCharacter;
+        }
+        *value = (*value * 10) + digit;
+    }
+    // Keep the values which are not part of the format.
+    const bool hasDate = (format == Format::ISO || format == Format::Long ||
+        format == Format::ISODate || format == Format::ISOBasicDate || format == Format::ShortDate);
+    const bool hasTime = (format == Format::ISO || format == Format::Long ||
+        format == Format::ISOTime || format == Format::ISOBasicTime || format == Format::ShortTime);
+    if (!hasDate) {
+        year = _year;
+        month = _month;
+        day = _day;
+    } else if (format == Format::ShortDate) {
+        year = _year;
+    }
+    if (!hasTime) {
+        hour = _hour;
+        minute = _minute;
+        second = _second;
+    } else if (format == Format::ShortTime) {
+        second = _second;
+    }
+    // Check the ranges.
+    if (year < 2000 || year > 9999 || month < 1 || month > 12 || day < 1 ||
+        day > getMaxDayPerMonth(year, month) || hour > 23 || minute > 59 || second > 59) {
+        return ParseResult::OutOfRange;
+    }
+    _year = year;
+    _month = month;
+    _day = day;
+    _hour = hour;
+    _minute = minute;
+    _second = second;
+    _dayOfWeek = calculateDayOfWeek(_year, _month, _day);
+    return ParseResult::Success;
+}
+
 
+DateTime DateTime::fromSecondsSince2000(uint32_t secondsSince2000)
+{
     // Calculate the time
     uint32_t secondsSinceMidnight = secondsSince2000%cSecondsPerDay;
     const uint8_t hours = secondsSinceMidnight/static_cast<uint32_t>(cSecondsPerHour);
@@ -340,23 +555,13 @@ DateTime DateTime::fromSecondsSince2000(uint32_t secondsSince2000)
     const uint8_t minutes = secondsSinceMidnight/static_cast<uint32_t>(cSecondsPerMinute);
     const uint8_t seconds = secondsSinceMidnight % static_cast<uint32_t>(cSecondsPerMinute);
     // Calculate the date
-    uint32_t days = secondsSince2000/static_cast<uint32_t>(cSecondsPerDay);
+    const uint32_t days = secondsSince2000/static_cast<uint32_t>(cSecondsPerDay);
     const uint8_t dayOfWeek = (days+6)%7; // 2000-01-01 was Saturday (6)
-    uint16_t year = 2000;
-    uint32_t daysForThisSection = getDaysForYear(year);
-    while (days >= daysForThisSection) {
-        ++year;
-        days -= daysForThisSection;
-        daysForThisSection = getDaysForYear(year);
-    }
-    uint16_t month = 1;
-    daysForThisSection = getMaxDayPerMonth(year, month);
-    while (days >= daysForThisSection) {
-        ++month;
-        days -= daysForThisSection;
-        daysForThisSection = getMaxDayPerMonth(year, month);
-    }
-    return DateTime(year, month, days+1, hours, minutes, seconds, dayOfWeek);
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    getDateFromDays(days, year, month, day);
+    return DateTime(year, month, day, hours, minutes, seconds, dayOfWeek);
 }
 
 
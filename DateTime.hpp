@@ -45,6 +45,31 @@ public:
         ShortTime, /// hh:mm
     };
 
+    /// The result of parsing a date/time.
+    ///
+    enum class ParseResult : uint8_t {
+        Success, ///< The text was parsed successfully.
+        WrongLength, ///< The text has not the length of the format.
+        InvalidCharacter, ///< A character does not match the format.
+        OutOfRange, ///< A value is out of the valid range.
+    };
+
+    /// Get the number of characters for a format, without the terminating zero.
+    ///
+    static constexpr size_t getStringLength(Format format) {
+        return (format == Format::ISO || format == Format::Long) ? 19 :
+            (format == Format::ISODate) ? 10 :
+            (format == Format::ISOBasicDate || format == Format::ISOTime) ? 8 :
+            (format == Format::ISOBasicTime || format == Format::ShortDate) ? 6 : 5;
+    }
+
+    /// A character buffer which is large enough for the given format.
+    ///
+    template<Format tFormat>
+    struct StringBuffer {
+        char data[getStringLength(tFormat) + 1]; ///< The characters with the terminating zero.
+    };
+
 public:
     /// Create the first possible date/time which is 2000-01-01 00:00:00.
     ///
@@ -129,6 +154,11 @@ public:
     ///
     void setDayOfWeek(uint8_t dayOfWeek);
 
+    /// Get the day of the year.
+    /// Value from 0=January 1st to 365=December 31st in leap years.
+    ///
+    uint16_t getDayOfYear() const;
+
     /// Get the hour.
     /// Value from 0-23.
     ///
@@ -144,19 +174,37 @@ public:
     ///
     uint8_t getSecond() const;
 
+    /// Advance this date/time by the given number of seconds.
+    ///
+    /// The seconds carry into the minutes, hours and days. The calendar is
+    /// only recalculated if the day changes to another month.
+    ///
+    void advanceSeconds(uint32_t seconds);
+
+    /// Advance this date/time by the given number of minutes.
+    ///
+    /// @see advanceSeconds()
+    ///
+    void advanceMinutes(uint32_t minutes);
+
+    /// Advance this date/time by the given number of days.
+    ///
+    /// Steps within the month or to the next month only need a few compares.
+    /// Larger steps are calculated using the day number.
+    ///
+    void advanceDays(uint32_t days);
+
     /// Get a new date/time with the given number of seconds added.
-    /// This is a slow operation.
     ///
     DateTime addSeconds(int32_t seconds) const;
 
     /// Get a new date/time with the given number of days added.
-    /// This is a slow operation.
     ///
     DateTime addDays(int32_t days) const;
 
     /// Get the number of seconds to the other date/time.
-    /// This is a slow operation. It works only correctly with differences
-    /// up to 62 years because of the limitation of the 32bit value.
+    /// It works only correctly with differences up to 62 years because
+    /// of the limitation of the 32bit value.
     ///
     int32_t secondsTo(const DateTime &other) const;
 
@@ -174,6 +222,40 @@ public:
     ///
     String toString(Format format) const;
 
+    /// Write this date/time as text into a buffer.
+    ///
+    /// This function does not use the heap or printf.
+    ///
+    /// @param out The buffer for the characters.
+    /// @param capacity The size of the buffer, it needs space for the terminating zero.
+    /// @param format The format to use.
+    /// @return The number of characters written, without the terminating zero.
+    ///    Zero if the buffer is too small, in this case nothing is written.
+    ///
+    size_t toChars(char *out, size_t capacity, Format format) const;
+
+    /// Parse a date/time from text.
+    ///
+    /// Only the values which are part of the format are changed. For example,
+    /// `Format::ISOTime` keeps the date and `Format::ShortDate` keeps the year and time.
+    /// This function does not use the heap.
+    ///
+    /// @param text The text to parse. It does not need a terminating zero.
+    /// @param length The length of the text.
+    /// @param format The expected format.
+    /// @return The result. If parsing fails, this date/time is not changed.
+    ///
+    ParseResult parse(const char *text, size_t length, Format format);
+
+    /// Write this date/time as text into a buffer for the format.
+    ///
+    /// @return The number of characters written, without the terminating zero.
+    ///
+    template<Format tFormat>
+    inline size_t toChars(StringBuffer<tFormat> &buffer) const {
+        return toChars(buffer.data, sizeof(buffer.data), tFormat);
+    }
+
 public:
     /// Create a new date/time object from the given unix time.
     ///
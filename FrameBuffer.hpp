@@ -0,0 +1,135 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "Color.hpp"
+#include "ColorOutput.hpp"
+#include "PixelOrder.hpp"
+#include "Random.hpp"
+
+#include <cstdint>
+
+
+/// The frame buffer for a blending effect.
+///
+/// The buffer keeps the two key frames of the effect: The base colors and
+/// the target colors which are blended in. The target frame is stored as
+/// one byte position on the gradient per pixel, its colors are calculated
+/// while rendering. There is no separate output buffer, the blended frame
+/// is rendered directly into the pixel buffer of the NeoPixel library.
+///
+/// Each pixel uses 5 bytes instead of 8 for two full key frames.
+///
+/// @tparam tPixelCount The number of pixels.
+///
+template<uint16_t tPixelCount>
+class FrameBuffer
+{
+public:
+    /// Create a new frame buffer with a black base frame.
+    ///
+    FrameBuffer() {
+    }
+
+public:
+    /// Get the number of pixels.
+    ///
+    inline static constexpr uint16_t getPixelCount() {
+        return tPixelCount;
+    }
+
+    /// Set the gradient for the target positions.
+    ///
+    /// Existing target positions are not changed, but use the new colors.
+    ///
+    /// @see setTargetPosition()
+    ///
+    void setGradient(const Color &begin, const Color &end) {
+        _gradientBegin = begin;
+        _gradientEnd = end;
+    }
+
+    /// Set the base frame to black.
+    ///
+    void clearBase() {
+        fillBase(Color());
+    }
+
+    /// Fill the base frame with one solid color.
+    ///
+    void fillBase(const Color &color) {
+        for (uint16_t i = 0; i < tPixelCount; ++i) {
+            _baseColors[i] = color;
+        }
+    }
+
+    /// Set a color of the target frame to a position on the gradient.
+    ///
+    /// @param index The index of the pixel.
+    /// @param position The position on the gradient, 0 = gradient begin.
+    ///
+    inline void setTargetPosition(uint16_t index, uint8_t position) {
+        _targetPositions[index] = position;
+    }
+
+    /// Set all colors of the target frame to random positions on the gradient.
+    ///
+    void fillTargetPositions(Random &random) {
+        random.fill(_targetPositions, tPixelCount);
+    }
+
+    /// Make the target frame the new base frame.
+    ///
+    /// The target positions are undefined afterwards and have to be
+    /// set before the next blend.
+    ///
+    void commitTarget() {
+        for (uint16_t i = 0; i < tPixelCount; ++i) {
+            _baseColors[i] = _gradientBegin.mix(_gradientEnd, _targetPositions[i]);
+        }
+    }
+
+    /// Render the blend of the two key frames into a pixel buffer.
+    ///
+    /// @tparam tOrder The pixel order of the strip.
+    /// @param output The output stage for brightness and gamma correction.
+    /// @param shift The blend amount, 0 = only the base frame.
+    /// @param pixelsOut The pixel buffer of the NeoPixel library.
+    /// @return `true` if the pixel buffer changed.
+    ///
+    template<PixelOrder tOrder>
+    bool render(const ColorOutput &output, uint8_t shift, uint8_t *pixelsOut) const {
+        const uint32_t beginRaw = _gradientBegin.getRaw();
+        const uint32_t endRaw = _gradientEnd.getRaw();
+        uint8_t difference = 0;
+        for (uint16_t i = 0; i < tPixelCount; ++i) {
+            const uint32_t targetRaw = Color::mixRaw(beginRaw, endRaw, _targetPositions[i]);
+            pixelsOut = output.writePixel<tOrder>(Color::mixRaw(_baseColors[i].getRaw(), targetRaw, shift), pixelsOut, difference);
+        }
+        return difference != 0;
+    }
+
+private:
+    Color _baseColors[tPixelCount]; ///< The base frame.
+    uint8_t _targetPositions[tPixelCount]; ///< The target frame as gradient positions.
+    Color _gradientBegin; ///< The begin of the gradient.
+    Color _gradientEnd; ///< The end of the gradient.
+};
+
+
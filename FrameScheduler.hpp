@@ -0,0 +1,118 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <cstdint>
+
+
+/// A scheduler for frames with a fixed time step.
+///
+/// Frames start at fixed multiples of the frame period, so the time spent
+/// to compute a frame does not add up as jitter. The remaining time of each
+/// period the core sleeps until the next interrupt. If a frame takes longer
+/// than one period, the schedule restarts from the current time.
+///
+/// The clock is a template parameter, so the scheduler can be checked with
+/// a mocked clock. The clock has to provide these two static functions:
+/// - `uint32_t getTime()`: The current time in microseconds.
+/// - `void waitForInterrupt()`: Sleep until the next interrupt.
+///
+/// @tparam tClock The clock to use, see `CpuClock`.
+///
+template<typename tClock>
+class FrameScheduler
+{
+public:
+    /// Create a new scheduler.
+    ///
+    /// @param framePeriod The frame period in microseconds.
+    ///
+    explicit FrameScheduler(uint32_t framePeriod)
+        : _framePeriod(framePeriod), _frameStart(0), _busyTime(0) {
+    }
+
+public:
+    /// Set the frame period.
+    ///
+    /// @param framePeriod The frame period in microseconds.
+    ///
+    inline void setFramePeriod(uint32_t framePeriod) {
+        _framePeriod = framePeriod;
+    }
+
+    /// Get the frame period in microseconds.
+    ///
+    inline uint32_t getFramePeriod() const {
+        return _framePeriod;
+    }
+
+    /// Start a new frame at the current time.
+    ///
+    inline void start() {
+        _frameStart = tClock::getTime();
+    }
+
+    /// Sleep until the next frame starts.
+    ///
+    /// @return The time in microseconds between the start of the last and the new frame.
+    ///
+    uint32_t waitForNextFrame() {
+        const uint32_t lastFrameStart = _frameStart;
+        uint32_t now = tClock::getTime();
+        _busyTime = now - lastFrameStart;
+        const uint32_t nextFrameStart = lastFrameStart + _framePeriod;
+        if (static_cast<int32_t>(nextFrameStart - now) <= 0) {
+            // The frame took too long, restart the schedule now.
+            _frameStart = now;
+        } else {
+            while (static_cast<int32_t>(nextFrameStart - now) > 0) {
+                tClock::waitForInterrupt();
+                now = tClock::getTime();
+            }
+            _frameStart = nextFrameStart;
+        }
+        return _frameStart - lastFrameStart;
+    }
+
+    /// Get the time spent in the last frame before `waitForNextFrame()` was called.
+    ///
+    /// @return The busy time in microseconds.
+    ///
+    inline uint32_t getBusyTime() const {
+        return _busyTime;
+    }
+
+    /// Get the load of the last frame.
+    ///
+    /// @return The load, from 0 = idle to 255 = the whole period or more.
+    ///
+    inline uint8_t getLoad() const {
+        if (_busyTime >= _framePeriod) {
+            return 0xff;
+        }
+        return static_cast<uint8_t>((static_cast<uint64_t>(_busyTime) * 0x100u) / _framePeriod);
+    }
+
+private:
+    uint32_t _framePeriod; ///< The frame period in microseconds.
+    uint32_t _frameStart; ///< The start time of the current frame.
+    uint32_t _busyTime; ///< The busy time of the last frame.
+};
+
+
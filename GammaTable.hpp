@@ -0,0 +1,86 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "ConstMath.hpp"
+
+#include <cstdint>
+
+
+/// @internal
+/// The value type for a gamma table with the given bit depth.
+///
+template<uint8_t tBits>
+struct GammaValueType;
+
+template<>
+struct GammaValueType<8> {
+    typedef uint8_t Type;
+};
+
+template<>
+struct GammaValueType<16> {
+    typedef uint16_t Type;
+};
+
+
+/// @internal
+/// The storage for a gamma table, expanded from an index list.
+///
+template<uint16_t tGamma, uint8_t tBits, typename tIndexList>
+struct GammaTableData;
+
+template<uint16_t tGamma, uint8_t tBits, uint16_t... tIndex>
+struct GammaTableData<tGamma, tBits, lr::ConstMath::IndexList<tIndex...>> {
+    typedef typename GammaValueType<tBits>::Type ValueType;
+
+    /// Calculate a single table entry.
+    ///
+    static constexpr ValueType value(uint16_t index) {
+        return static_cast<ValueType>(lr::ConstMath::round(
+            lr::ConstMath::pow(static_cast<double>(index) / 255.0, static_cast<double>(tGamma) / 100.0)
+            * static_cast<double>((1ul << tBits) - 1)));
+    }
+
+    static constexpr ValueType cValues[256] = { value(tIndex)... };
+};
+
+template<uint16_t tGamma, uint8_t tBits, uint16_t... tIndex>
+constexpr typename GammaTableData<tGamma, tBits, lr::ConstMath::IndexList<tIndex...>>::ValueType
+    GammaTableData<tGamma, tBits, lr::ConstMath::IndexList<tIndex...>>::cValues[256];
+
+
+/// A gamma correction table generated at compile time.
+///
+/// The table maps each 8bit color value to the corrected output value.
+/// It is calculated by the compiler and placed in flash memory, so there
+/// is no cost at startup.
+///
+/// Example: `GammaTable<280, 8>::cValues` is the 8bit table for gamma 2.8.
+///
+/// @tparam tGamma The gamma exponent in hundredths, e.g. `280` for 2.8.
+/// @tparam tBits The bit depth of the output values, `8` or `16`.
+///
+template<uint16_t tGamma, uint8_t tBits>
+struct GammaTable : GammaTableData<tGamma, tBits, typename lr::ConstMath::MakeIndexList<256>::Type> {
+    static_assert(tBits == 8 || tBits == 16, "Only 8bit and 16bit gamma tables are supported.");
+    static_assert(tGamma > 0, "The gamma exponent has to be greater than zero.");
+};
+
+
@@ -0,0 +1,68 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <cstdint>
+
+
+namespace lr {
+
+
+/// The interface to access the registers of a chip on an I2C bus.
+///
+/// Drivers use this interface instead of the `Wire` object, so they can be
+/// used with another bus implementation or with a mocked chip on the host.
+///
+/// @see WireBus
+///
+class I2cBus
+{
+public:
+    /// dtor
+    ///
+    virtual ~I2cBus() = default;
+
+public:
+    /// Write a block of registers in one transaction.
+    ///
+    /// @param address The 7-bit address of the chip.
+    /// @param firstRegister The address of the first register.
+    /// @param data The values to write.
+    /// @param count The number of registers to write.
+    /// @return `true` on success, `false` if the chip did not acknowledge the transfer.
+    ///
+    virtual bool writeRegisters(uint8_t address, uint8_t firstRegister, const uint8_t *data, uint8_t count) = 0;
+
+    /// Read a block of registers.
+    ///
+    /// The register address is written first, then the values are read.
+    ///
+    /// @param address The 7-bit address of the chip.
+    /// @param firstRegister The address of the first register.
+    /// @param data The buffer for the values.
+    /// @param count The number of registers to read.
+    /// @return `true` on success, `false` if the chip did not acknowledge the transfer.
+    ///
+    virtual bool readRegisters(uint8_t address, uint8_t firstRegister, uint8_t *data, uint8_t count) = 0;
+};
+
+
+}
+
+
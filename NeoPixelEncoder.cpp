@@ -0,0 +1,72 @@
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "NeoPixelEncoder.hpp"
+
+
+namespace NeoPixelEncoder {
+
+
+namespace {
+
+
+// The 12 SPI bits for each nibble, with the three bit encoding.
+static const uint16_t cThreeBitNibbles[] = {
+    0b100100100100, 0b100100100110, 0b100100110100, 0b100100110110,
+    0b100110100100, 0b100110100110, 0b100110110100, 0b100110110110,
+    0b110100100100, 0b110100100110, 0b110100110100, 0b110100110110,
+    0b110110100100, 0b110110100110, 0b110110110100, 0b110110110110};
+
+// The 16 SPI bits for each nibble, with the four bit encoding.
+static const uint16_t cFourBitNibbles[] = {
+    0x8888, 0x888c, 0x88c8, 0x88cc, 0x8c88, 0x8c8c, 0x8cc8, 0x8ccc,
+    0xc888, 0xc88c, 0xc8c8, 0xc8cc, 0xcc88, 0xcc8c, 0xccc8, 0xcccc};
+
+
+}
+
+
+size_t encode(Encoding encoding, const uint8_t *pixels, size_t byteCount, uint8_t *out)
+{
+    uint8_t *const begin = out;
+    if (encoding == Encoding::ThreeBit) {
+        for (size_t i = 0; i < byteCount; ++i) {
+            const uint32_t bits = (static_cast<uint32_t>(cThreeBitNibbles[pixels[i] >> 4]) << 12)
+                | cThreeBitNibbles[pixels[i] & 0xf];
+            *out++ = static_cast<uint8_t>(bits >> 16);
+            *out++ = static_cast<uint8_t>(bits >> 8);
+            *out++ = static_cast<uint8_t>(bits);
+        }
+    } else {
+        for (size_t i = 0; i < byteCount; ++i) {
+            const uint16_t high = cFourBitNibbles[pixels[i] >> 4];
+            const uint16_t low = cFourBitNibbles[pixels[i] & 0xf];
+            *out++ = static_cast<uint8_t>(high >> 8);
+            *out++ = static_cast<uint8_t>(high);
+            *out++ = static_cast<uint8_t>(low >> 8);
+            *out++ = static_cast<uint8_t>(low);
+        }
+    }
+    const size_t resetSize = getResetSize(encoding);
+    for (size_t i = 0; i < resetSize; ++i) {
+        *out++ = 0;
+    }
+    return static_cast<size_t>(out - begin);
+}
+
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <cstddef>
+#include <cstdint>
+
+
+/// @namespace NeoPixelEncoder
+///
+/// Encode pixel data into a waveform for a SPI data line.
+///
+/// Each bit of the NeoPixel protocol is sent as a group of SPI bits, which
+/// starts with a high level. A short high pulse is a zero bit, a long high
+/// pulse is a one bit. The encoded frame ends with low bytes for the reset.
+///
+/// These are pure functions without any hardware access.
+
+
+namespace NeoPixelEncoder {
+
+
+/// The number of SPI bits for one NeoPixel bit.
+///
+enum class Encoding : uint8_t {
+    ThreeBit = 3, ///< `100` and `110` at 2.4 MHz.
+    FourBit = 4, ///< `1000` and `1100` at 3.0-3.2 MHz, with more timing margin.
+};
+
+/// The SPI clock for an encoding in Hz.
+///
+/// The four bit encoding uses 3 MHz, the next clock the SAMD21 can
+/// derive from 48 MHz. This is still within the NeoPixel timing.
+///
+constexpr uint32_t getSpiClock(Encoding encoding)
+{
+    return encoding == Encoding::ThreeBit ? 2400000ul : 3000000ul;
+}
+
+/// The number of low bytes for the reset at the end of a frame.
+///
+/// The reset has to be at least 280 microseconds for the WS2812B, 300 microseconds are used.
+///
+constexpr size_t getResetSize(Encoding encoding)
+{
+    return static_cast<size_t>((getSpiClock(encoding) / 1000ul * 300ul / 1000ul + 7) / 8);
+}
+
+/// The size of an encoded frame in bytes.
+///
+/// @param encoding The encoding.
+/// @param byteCount The number of bytes in the pixel buffer.
+///
+constexpr size_t getEncodedSize(Encoding encoding, size_t byteCount)
+{
+    return byteCount * static_cast<size_t>(encoding) + getResetSize(encoding);
+}
+
+/// Encode the bytes of a pixel buffer.
+///
+/// @param encoding The encoding to use.
+/// @param pixels The pixel buffer in wire order.
+/// @param byteCount The number of bytes in the pixel buffer.
+/// @param out The output buffer with `getEncodedSize(encoding, byteCount)` bytes.
+/// @return The number of bytes written.
+///
+size_t encode(Encoding encoding, const uint8_t *pixels, size_t byteCount, uint8_t *out);
+
+
+}
+
+
@@ -0,0 +1,53 @@
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "PackedDateTime.hpp"
+
+
+namespace lr {
+
+
+constexpr uint16_t PackedDateTime::cFirstYear;
+constexpr uint16_t PackedDateTime::cLastYear;
+
+
+DateTime PackedDateTime::toDateTime() const
+{
+    return DateTime(getYear(), getMonth(), getDay(), getHour(), getMinute(), getSecond());
+}
+
+
+bool PackedDateTime::fromDateTime(const DateTime &dateTime, PackedDateTime &packedOut)
+{
+    if (dateTime.getYear() > cLastYear) {
+        return false;
+    }
+    packedOut._value = pack(dateTime.getYear(), dateTime.getMonth(), dateTime.getDay(),
+        dateTime.getHour(), dateTime.getMinute(), dateTime.getSecond());
+    return true;
+}
+
+
+PackedDateTime PackedDateTime::fromValue(uint32_t value)
+{
+    PackedDateTime result;
+    result._value = value;
+    return result;
+}
+
+
+}
@@ -0,0 +1,161 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "DateTime.hpp"
+
+#include <cstdint>
+
+
+namespace lr {
+
+
+/// A date/time packed into a single 32bit value.
+///
+/// The fields are stored from the most to the least significant bits:
+/// year since 2000 (6 bits), month (4 bits), day (5 bits), hour (5 bits),
+/// minute (6 bits) and second (6 bits). Because of this order, two values
+/// are compared with a single integer comparison.
+///
+/// The packed value uses half the memory of a `DateTime`, but is limited
+/// to the years 2000-2063. The day of the week is not stored. Packing a
+/// later date/time fails, see `fromDateTime()`.
+///
+class PackedDateTime
+{
+public:
+    /// The first year which can be stored.
+    ///
+    static constexpr uint16_t cFirstYear = 2000;
+
+    /// The last year which can be stored.
+    ///
+    static constexpr uint16_t cLastYear = 2063;
+
+public:
+    /// Create the first possible date/time which is 2000-01-01 00:00:00.
+    ///
+    constexpr PackedDateTime()
+        : _value(pack(cFirstYear, 1, 1, 0, 0, 0)) {
+    }
+
+public:
+    /// Compare this date/time to another value
+    ///
+    inline bool operator==(const PackedDateTime &other) const { return _value == other._value; }
+
+    /// Compare this date/time to another value
+    ///
+    inline bool operator!=(const PackedDateTime &other) const { return _value != other._value; }
+
+    /// Compare this date/time to another value
+    ///
+    inline bool operator<(const PackedDateTime &other) const { return _value < other._value; }
+
+    /// Compare this date/time to another value
+    ///
+    inline bool operator<=(const PackedDateTime &other) const { return _value <= other._value; }
+
+    /// Compare this date/time to another value
+    ///
+    inline bool operator>(const PackedDateTime &other) const { return _value > other._value; }
+
+    /// Compare this date/time to another value
+    ///
+    inline bool operator>=(const PackedDateTime &other) const { return _value >= other._value; }
+
+public:
+    /// Get the year.
+    /// Value from 2000-2063.
+    ///
+    inline uint16_t getYear() const { return cFirstYear + (_value >> 26); }
+
+    /// Get the month.
+    /// Value from 1=January to 12=December.
+    ///
+    inline uint8_t getMonth() const { return (_value >> 22) & 0xf; }
+
+    /// Get the day.
+    /// Value from 1 to 31.
+    ///
+    inline uint8_t getDay() const { return (_value >> 17) & 0x1f; }
+
+    /// Get the hour.
+    /// Value from 0-23.
+    ///
+    inline uint8_t getHour() const { return (_value >> 12) & 0x1f; }
+
+    /// Get the minute.
+    /// Value from 0-59.
+    ///
+    inline uint8_t getMinute() const { return (_value >> 6) & 0x3f; }
+
+    /// Get the second.
+    /// Value from 0-59.
+    ///
+    inline uint8_t getSecond() const { return _value & 0x3f; }
+
+    /// Get the packed value.
+    ///
+    inline uint32_t getValue() const { return _value; }
+
+    /// Convert this value into a date/time.
+    ///
+    /// The day of the week is calculated.
+    ///
+    DateTime toDateTime() const;
+
+public:
+    /// Pack a date/time.
+    ///
+    /// A date/time after 2063 can not be stored. In this case, `packedOut`
+    /// is not changed and the call fails, a value is never clamped.
+    ///
+    /// @param dateTime The date/time to pack.
+    /// @param packedOut The packed date/time.
+    /// @return `true` on success, `false` if the year is after 2063.
+    ///
+    static bool fromDateTime(const DateTime &dateTime, PackedDateTime &packedOut);
+
+    /// Create a date/time from a packed value.
+    ///
+    /// The value is not checked.
+    ///
+    static PackedDateTime fromValue(uint32_t value);
+
+private:
+    /// Pack the given values.
+    ///
+    static constexpr uint32_t pack(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second) {
+        return (static_cast<uint32_t>(year - cFirstYear) << 26)
+            | (static_cast<uint32_t>(month) << 22)
+            | (static_cast<uint32_t>(day) << 17)
+            | (static_cast<uint32_t>(hour) << 12)
+            | (static_cast<uint32_t>(minute) << 6)
+            | static_cast<uint32_t>(second);
+    }
+
+private:
+    uint32_t _value; ///< The packed date/time.
+};
+
+
+}
+
+
@@ -0,0 +1,129 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "Color.hpp"
+#include "ColorOutput.hpp"
+#include "PixelOrder.hpp"
+#include "Random.hpp"
+
+#include <cstdint>
+
+
+/// A frame buffer for a blending effect on a two color gradient.
+///
+/// This buffer has the same interface as `FrameBuffer`, but each pixel of a
+/// key frame is stored as a one byte position on the gradient. The colors
+/// of all 256 positions are calculated once in `setGradient()`.
+///
+/// The palette uses 1024 bytes, each pixel 2 bytes instead of 5. This buffer
+/// uses less memory than `FrameBuffer` for more than 340 pixels.
+///
+/// @tparam tPixelCount The number of pixels.
+///
+template<uint16_t tPixelCount>
+class PaletteFrameBuffer
+{
+public:
+    /// Create a new frame buffer with black key frames.
+    ///
+    PaletteFrameBuffer()
+        : _baseFrame(0), _isBaseBlack(true) {
+        setGradient(Color(), Color());
+    }
+
+public:
+    /// Get the number of pixels.
+    ///
+    inline static constexpr uint16_t getPixelCount() {
+        return tPixelCount;
+    }
+
+    /// Set the gradient and calculate the palette.
+    ///
+    /// Existing key frames are not changed, but use the new colors.
+    ///
+    void setGradient(const Color &begin, const Color &end) {
+        for (uint16_t i = 0; i < 0x100; ++i) {
+            _palette[i] = begin.mix(end, static_cast<uint8_t>(i)).getRaw();
+        }
+    }
+
+    /// Set the base frame to black.
+    ///
+    /// Black is no position on the gradient, so it is tracked until
+    /// the next call of `commitTarget()`.
+    ///
+    void clearBase() {
+        _isBaseBlack = true;
+    }
+
+    /// Set a color of the target frame to a position on the gradient.
+    ///
+    /// @param index The index of the pixel.
+    /// @param position The position on the gradient, 0 = gradient begin.
+    ///
+    inline void setTargetPosition(uint16_t index, uint8_t position) {
+        _frames[_baseFrame^1][index] = position;
+    }
+
+    /// Set all colors of the target frame to random positions on the gradient.
+    ///
+    void fillTargetPositions(Random &random) {
+        random.fill(_frames[_baseFrame^1], tPixelCount);
+    }
+
+    /// Make the target frame the new base frame.
+    ///
+    /// The content of the new target frame is undefined and has to be
+    /// set before the next blend.
+    ///
+    inline void commitTarget() {
+        _baseFrame ^= 1;
+        _isBaseBlack = false;
+    }
+
+    /// Render the blend of the two key frames into a pixel buffer.
+    ///
+    /// @tparam tOrder The pixel order of the strip.
+    /// @param output The output stage for brightness and gamma correction.
+    /// @param shift The blend amount, 0 = only the base frame.
+    /// @param pixelsOut The pixel buffer of the NeoPixel library.
+    /// @return `true` if the pixel buffer changed.
+    ///
+    template<PixelOrder tOrder>
+    bool render(const ColorOutput &output, uint8_t shift, uint8_t *pixelsOut) const {
+        const uint8_t *base = _frames[_baseFrame];
+        const uint8_t *target = _frames[_baseFrame^1];
+        uint8_t difference = 0;
+        for (uint16_t i = 0; i < tPixelCount; ++i) {
+            const uint32_t baseColor = (_isBaseBlack ? 0 : _palette[base[i]]);
+            pixelsOut = output.writePixel<tOrder>(Color::mixRaw(baseColor, _palette[target[i]], shift), pixelsOut, difference);
+        }
+        return difference != 0;
+    }
+
+private:
+    uint32_t _palette[0x100]; ///< The packed colors for all gradient positions.
+    uint8_t _frames[2][tPixelCount]; ///< The two key frames as gradient positions.
+    uint8_t _baseFrame; ///< The index of the base frame.
+    bool _isBaseBlack; ///< If the base frame is black.
+};
+
+
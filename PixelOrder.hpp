@@ -0,0 +1,82 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <cstdint>
+
+
+/// The order of the color channels on the wire.
+///
+enum class PixelOrder : uint8_t {
+    GRB, ///< Green, red, blue.
+    GRBW, ///< Green, red, blue, white.
+    RGB, ///< Red, green, blue.
+    RGBW, ///< Red, green, blue, white.
+};
+
+
+/// The byte offsets of the channels for a pixel order.
+///
+/// `cNeoPixelType` is the matching `NEO_*` order value for the
+/// NeoPixel library.
+///
+template<PixelOrder tOrder>
+struct PixelOrderTraits;
+
+template<>
+struct PixelOrderTraits<PixelOrder::GRB> {
+    static constexpr uint8_t cChannelCount = 3;
+    static constexpr uint8_t cRedOffset = 1;
+    static constexpr uint8_t cGreenOffset = 0;
+    static constexpr uint8_t cBlueOffset = 2;
+    static constexpr uint8_t cWhiteOffset = cRedOffset;
+    static constexpr uint8_t cNeoPixelType = (cWhiteOffset<<6)|(cRedOffset<<4)|(cGreenOffset<<2)|cBlueOffset;
+};
+
+template<>
+struct PixelOrderTraits<PixelOrder::GRBW> {
+    static constexpr uint8_t cChannelCount = 4;
+    static constexpr uint8_t cRedOffset = 1;
+    static constexpr uint8_t cGreenOffset = 0;
+    static constexpr uint8_t cBlueOffset = 2;
+    static constexpr uint8_t cWhiteOffset = 3;
+    static constexpr uint8_t cNeoPixelType = (cWhiteOffset<<6)|(cRedOffset<<4)|(cGreenOffset<<2)|cBlueOffset;
+};
+
+template<>
+struct PixelOrderTraits<PixelOrder::RGB> {
+    static constexpr uint8_t cChannelCount = 3;
+    static constexpr uint8_t cRedOffset = 0;
+    static constexpr uint8_t cGreenOffset = 1;
+    static constexpr uint8_t cBlueOffset = 2;
+    static constexpr uint8_t cWhiteOffset = cRedOffset;
+    static constexpr uint8_t cNeoPixelType = (cWhiteOffset<<6)|(cRedOffset<<4)|(cGreenOffset<<2)|cBlueOffset;
+};
+
+template<>
+struct PixelOrderTraits<PixelOrder::RGBW> {
+    static constexpr uint8_t cChannelCount = 4;
+    static constexpr uint8_t cRedOffset = 0;
+    static constexpr uint8_t cGreenOffset = 1;
+    static constexpr uint8_t cBlueOffset = 2;
+    static constexpr uint8_t cWhiteOffset = 3;
+    static constexpr uint8_t cNeoPixelType = (cWhiteOffset<<6)|(cRedOffset<<4)|(cGreenOffset<<2)|cBlueOffset;
+};
+
+
@@ -0,0 +1,52 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <cstddef>
+#include <cstdint>
+
+
+/// The interface to send an encoded frame in the background.
+///
+/// An implementation usually starts a DMA transfer to a SPI peripheral.
+///
+class PixelTransfer
+{
+public:
+    /// dtor
+    ///
+    virtual ~PixelTransfer() = default;
+
+public:
+    /// Check if a transfer is in progress.
+    ///
+    virtual bool isBusy() const = 0;
+
+    /// Start a new transfer.
+    ///
+    /// This is only called if no transfer is in progress. The data
+    /// is not changed until the transfer is complete.
+    ///
+    /// @param data The encoded data to send.
+    /// @param size The number of bytes to send.
+    ///
+    virtual void start(const uint8_t *data, size_t size) = 0;
+};
+
+
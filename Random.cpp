@@ -0,0 +1,55 @@
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Random.hpp"
+
+
+constexpr uint32_t Random::cDefaultSeed;
+
+
+Random::Random(uint32_t seed)
+{
+    setSeed(seed);
+}
+
+
+void Random::setSeed(uint32_t seed)
+{
+    _state = (seed != 0 ? seed : cDefaultSeed);
+}
+
+
+void Random::fill(uint8_t *out, size_t count)
+{
+    while (count >= 4) {
+        const uint32_t value = next();
+        out[0] = static_cast<uint8_t>(value);
+        out[1] = static_cast<uint8_t>(value >> 8);
+        out[2] = static_cast<uint8_t>(value >> 16);
+        out[3] = static_cast<uint8_t>(value >> 24);
+        out += 4;
+        count -= 4;
+    }
+    if (count > 0) {
+        uint32_t value = next();
+        while (count > 0) {
+            *out++ = static_cast<uint8_t>(value);
+            value >>= 8;
+            --count;
+        }
+    }
+}
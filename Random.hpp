@@ -0,0 +1,81 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <cstddef>
+#include <cstdint>
+
+
+/// A small and fast pseudo random number generator.
+///
+/// This is a xorshift32 generator with a period of 2^32-1. The same seed
+/// always produces the same stream of numbers.
+///
+class Random
+{
+public:
+    /// The seed used if no seed is given.
+    ///
+    static constexpr uint32_t cDefaultSeed = 0x2545f491u;
+
+public:
+    /// Create a new generator.
+    ///
+    /// @param seed The initial seed. Zero is replaced with the default seed.
+    ///
+    explicit Random(uint32_t seed = cDefaultSeed);
+
+public:
+    /// Restart the stream with a new seed.
+    ///
+    /// @param seed The new seed. Zero is replaced with the default seed.
+    ///
+    void setSeed(uint32_t seed);
+
+    /// Get the next 32bit value.
+    ///
+    inline uint32_t next() {
+        uint32_t x = _state;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        _state = x;
+        return x;
+    }
+
+    /// Get the next 8bit value.
+    ///
+    inline uint8_t nextByte() {
+        return static_cast<uint8_t>(next() >> 24);
+    }
+
+    /// Fill a buffer with random bytes.
+    ///
+    /// Each step of the generator produces four bytes.
+    ///
+    /// @param out The buffer to fill.
+    /// @param count The number of bytes to write.
+    ///
+    void fill(uint8_t *out, size_t count);
+
+private:
+    uint32_t _state; ///< The current state, never zero.
+};
+
+
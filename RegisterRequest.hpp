@@ -0,0 +1,85 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <cstdint>
+
+
+namespace lr {
+
+
+/// A deferred read or write of a block of chip registers.
+///
+/// The request and its data buffer are owned by the caller and have to
+/// exist until the request is done. Submit the request to a `RequestQueue`
+/// and check the state or use the callback to get the result. The transfer
+/// happens when the queue is processed, not in the background.
+///
+struct RegisterRequest
+{
+    /// The direction of the transfer.
+    ///
+    enum class Type : uint8_t {
+        Read, ///< Read the registers into the buffer.
+        Write, ///< Write the buffer into the registers.
+    };
+
+    /// The state of the request.
+    ///
+    enum class State : uint8_t {
+        Idle, ///< The request was not submitted yet.
+        Pending, ///< The request is waiting in the queue.
+        Done, ///< The transfer is complete.
+        Failed, ///< The transfer failed, the data is undefined for a read.
+    };
+
+    /// The function which is called after the transfer.
+    ///
+    typedef void (*Callback)(RegisterRequest &request);
+
+    /// Create a new idle request.
+    ///
+    /// @param type The direction of the transfer.
+    /// @param firstRegister The address of the first register.
+    /// @param data The buffer with the register values.
+    /// @param count The number of registers.
+    /// @param callback The function to call after the transfer, or `nullptr`.
+    ///
+    RegisterRequest(Type type, uint8_t firstRegister, uint8_t *data, uint8_t count, Callback callback = nullptr)
+        : type(type), firstRegister(firstRegister), data(data), count(count), callback(callback), state(State::Idle) {
+    }
+
+    /// Check if the request is waiting in a queue.
+    ///
+    inline bool isPending() const {
+        return state == State::Pending;
+    }
+
+    Type type; ///< The direction of the transfer.
+    uint8_t firstRegister; ///< The address of the first register.
+    uint8_t *data; ///< The buffer with the register values.
+    uint8_t count; ///< The number of registers.
+    Callback callback; ///< The function to call after the transfer, or `nullptr`.
+    volatile State state; ///< The current state of the request.
+};
+
+
+}
+
+
@@ -0,0 +1,113 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "RegisterRequest.hpp"
+
+#include <cstdint>
+
+
+namespace lr {
+
+
+/// A fixed size queue of register requests.
+///
+/// The queue only stores pointers to the requests, so it does not need
+/// any memory for the data. The requests are executed in the order they
+/// were submitted. The transfer itself is done by a function, which is
+/// passed to `processNext()`, so the queue can be used with any bus.
+///
+/// The queue is not interrupt safe. `submit()` and `processNext()` have to
+/// be called from the same context, e.g. the main loop.
+///
+/// @tparam tCapacity The maximum number of pending requests.
+///
+template<uint8_t tCapacity>
+class RequestQueue
+{
+public:
+    /// Create an empty queue.
+    ///
+    RequestQueue()
+        : _first(0), _count(0) {
+    }
+
+public:
+    /// Submit a request.
+    ///
+    /// @param request The request to add to the queue.
+    /// @return `true` on success, `false` if the queue is full or the request is already pending.
+    ///
+    bool submit(RegisterRequest &request) {
+        if (_count >= tCapacity || request.isPending()) {
+            return false;
+        }
+        request.state = RegisterRequest::State::Pending;
+        _requests[(_first + _count) % tCapacity] = &request;
+        ++_count;
+        return true;
+    }
+
+    /// Check if there are no pending requests.
+    ///
+    inline bool isEmpty() const {
+        return _count == 0;
+    }
+
+    /// Get the number of pending requests.
+    ///
+    inline uint8_t getCount() const {
+        return _count;
+    }
+
+    /// Execute the next pending request.
+    ///
+    /// The request is removed from the queue before the callback is called,
+    /// so the callback can submit the request again.
+    ///
+    /// @param transfer A function `bool(RegisterRequest&)` which does the transfer
+    ///    and returns `false` if it failed.
+    /// @return `true` if a request was executed, `false` if the queue was empty.
+    ///
+    template<typename tTransfer>
+    bool processNext(tTransfer transfer) {
+        if (_count == 0) {
+            return false;
+        }
+        RegisterRequest &request = *_requests[_first];
+        _first = (_first + 1) % tCapacity;
+        --_count;
+        const bool success = transfer(request);
+        request.state = (success ? RegisterRequest::State::Done : RegisterRequest::State::Failed);
+        if (request.callback != nullptr) {
+            request.callback(request);
+        }
+        return true;
+    }
+
+private:
+    RegisterRequest *_requests[tCapacity]; ///< The ring buffer with the pending requests.
+    uint8_t _first; ///< The index of the first pending request.
+    uint8_t _count; ///< The number of pending requests.
+};
+
+
+}
+
+
@@ -0,0 +1,191 @@
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Schedule.hpp"
+
+
+namespace lr {
+
+
+namespace {
+
+
+// The number of minutes per day.
+static const uint16_t cMinutesPerDay = 1440;
+
+
+}
+
+
+constexpr uint8_t ScheduleRule::cSunday;
+constexpr uint8_t ScheduleRule::cMonday;
+constexpr uint8_t ScheduleRule::cTuesday;
+constexpr uint8_t ScheduleRule::cWednesday;
+constexpr uint8_t ScheduleRule::cThursday;
+constexpr uint8_t ScheduleRule::cFriday;
+constexpr uint8_t ScheduleRule::cSaturday;
+constexpr uint8_t ScheduleRule::cEveryDay;
+constexpr uint16_t ScheduleRule::cSunrise;
+constexpr uint16_t ScheduleRule::cSunset;
+constexpr uint16_t Schedule::cSearchDays;
+
+
+Schedule::Day::Day(const DateTime &dateTime, const TimeZone *timeZone)
+    : date(static_cast<uint16_t>(dateTime.getMonth()) * 100 + dateTime.getDay()),
+    dayOfYear(dateTime.getDayOfYear()),
+    weekdayMask(static_cast<uint8_t>(1 << dateTime.getDayOfWeek())),
+    solarShift(0)
+{
+    const DateTime previous = dateTime.addDays(-1);
+    previousDate = static_cast<uint16_t>(previous.getMonth()) * 100 + previous.getDay();
+    previousWeekdayMask = static_cast<uint8_t>(1 << previous.getDayOfWeek());
+    if (timeZone != nullptr) {
+        // Use the noon of the day, the transitions are always in the night.
+        DateTime noon = dateTime;
+        noon.setTime(12, 0, 0);
+        if (timeZone->isDaylightSaving(timeZone->toUtc(noon))) {
+            solarShift = TimeZone::cDaylightSavingOffset;
+        }
+    }
+}
+
+
+Schedule::Schedule(const ScheduleRule *rules, uint8_t ruleCount)
+    : _rules(rules), _ruleCount(ruleCount), _sunrise(nullptr), _sunset(nullptr), _timeZone(nullptr)
+{
+}
+
+
+void Schedule::setSolarTable(const uint16_t *sunrise, const uint16_t *sunset)
+{
+    _sunrise = sunrise;
+    _sunset = sunset;
+}
+
+
+void Schedule::setTimeZone(const TimeZone *timeZone)
+{
+    _timeZone = timeZone;
+}
+
+
+bool Schedule::isOn(const DateTime &dateTime) const
+{
+    return isOn(Day(dateTime, _timeZone), ScheduleRule::time(dateTime.getHour(), dateTime.getMinute()));
+}
+
+
+DateTime Schedule::nextTransition(const DateTime &now) const
+{
+    const bool currentState = isOn(now);
+    DateTime dateTime = now;
+    uint16_t minuteOfDay = ScheduleRule::time(now.getHour(), now.getMinute());
+    for (uint16_t dayIndex = 0; dayIndex < cSearchDays; ++dayIndex) {
+        const Day day(dateTime, _timeZone);
+        if (dayIndex > 0 && isOn(day, 0) != currentState) {
+            return dateTime; // Change at midnight.
+        }
+        for (minuteOfDay = getNextBoundary(day, minuteOfDay); minuteOfDay < cMinutesPerDay;
+            minuteOfDay = getNextBoundary(day, minuteOfDay)) {
+            if (isOn(day, minuteOfDay) != currentState) {
+                dateTime.setTime(minuteOfDay / 60, minuteOfDay % 60, 0);
+                return dateTime;
+            }
+        }
+        dateTime.setTime(0, 0, 0);
+        dateTime.advanceDays(1);
+        minuteOfDay = 0;
+    }
+    return dateTime;
+}
+
+
+bool Schedule::isOn(const Day &day, uint16_t minuteOfDay) const
+{
+    bool result = false;
+    for (uint8_t i = 0; i < _ruleCount; ++i) {
+        const ScheduleRule &rule = _rules[i];
+        const uint16_t timeBegin = getMinuteOfDay(day, rule.timeBegin);
+        const uint16_t timeEnd = getMinuteOfDay(day, rule.timeEnd);
+        bool isMatch;
+        if (timeBegin <= timeEnd) {
+            isMatch = minuteOfDay >= timeBegin && minuteOfDay < timeEnd
+                && isDayMatch(rule, day.date, day.weekdayMask);
+        } else if (timeBegin < cMinutesPerDay) {
+            // The window wraps over midnight, the part after midnight belongs to the previous day.
+            isMatch = (minuteOfDay >= timeBegin && isDayMatch(rule, day.date, day.weekdayMask))
+                || (minuteOfDay < timeEnd && isDayMatch(rule, day.previousDate, day.previousWeekdayMask));
+        } else {
+            isMatch = false; // A solar event without solar table.
+        }
+        if (isMatch) {
+            result = (rule.action == ScheduleRule::Action::On);
+        }
+    }
+    return result;
+}
+
+
+bool Schedule::isDayMatch(const ScheduleRule &rule, uint16_t date, uint8_t weekdayMask)
+{
+    if ((rule.weekdays & weekdayMask) == 0) {
+        return false;
+    }
+    if (rule.dateBegin <= rule.dateEnd) {
+        return date >= rule.dateBegin && date <= rule.dateEnd;
+    }
+    return date >= rule.dateBegin || date <= rule.dateEnd;
+}
+
+
+uint16_t Schedule::getNextBoundary(const Day &day, uint16_t minuteOfDay) const
+{
+    uint16_t result = cMinutesPerDay;
+    for (uint8_t i = 0; i < _ruleCount; ++i) {
+        const ScheduleRule &rule = _rules[i];
+        const uint16_t timeBegin = getMinuteOfDay(day, rule.timeBegin);
+        if (timeBegin > minuteOfDay && timeBegin < result) {
+            result = timeBegin;
+        }
+        const uint16_t timeEnd = getMinuteOfDay(day, rule.timeEnd);
+        if (timeEnd > minuteOfDay && timeEnd < result) {
+            result = timeEnd;
+        }
+    }
+    return result;
+}
+
+
+uint16_t Schedule::getMinuteOfDay(const Day &day, uint16_t time) const
+{
+    const uint16_t *table;
+    if (time == ScheduleRule::cSunrise) {
+        table = _sunrise;
+    } else if (time == ScheduleRule::cSunset) {
+        table = _sunset;
+    } else {
+        return time;
+    }
+    if (table == nullptr) {
+        return cMinutesPerDay;
+    }
+    const uint16_t minute = table[day.dayOfYear] + day.solarShift;
+    return minute < cMinutesPerDay ? minute : cMinutesPerDay - 1;
+}
+
+
+}
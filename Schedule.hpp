@@ -0,0 +1,179 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "DateTime.hpp"
+#include "TimeZone.hpp"
+
+#include <cstdint>
+
+
+namespace lr {
+
+
+/// A single rule of a schedule.
+///
+/// A rule matches if the weekday is in the mask, the date is in the date
+/// range and the time is in the time window. Dates are written as
+/// `month*100+day`, e.g. `1224` for December 24th. If the end date is before
+/// the begin date, the range wraps over the new year.
+///
+/// If the end time is before the begin time, the time window wraps over
+/// midnight. The part after midnight belongs to the day the window began,
+/// so it is matched with the weekday and date of the previous day. A rule
+/// for Fridays from 22:00 to 02:00 is on until Saturday 02:00.
+///
+/// The begin and end of the time window can be `cSunrise` or `cSunset`,
+/// if the schedule has a solar table. See `Schedule::setSolarTable()`.
+///
+struct ScheduleRule
+{
+    /// The action of a rule.
+    ///
+    enum class Action : uint8_t {
+        Off, ///< Switch the decoration off.
+        On, ///< Switch the decoration on.
+    };
+
+    static constexpr uint8_t cSunday = (1<<0); ///< The mask for Sunday.
+    static constexpr uint8_t cMonday = (1<<1); ///< The mask for Monday.
+    static constexpr uint8_t cTuesday = (1<<2); ///< The mask for Tuesday.
+    static constexpr uint8_t cWednesday = (1<<3); ///< The mask for Wednesday.
+    static constexpr uint8_t cThursday = (1<<4); ///< The mask for Thursday.
+    static constexpr uint8_t cFriday = (1<<5); ///< The mask for Friday.
+    static constexpr uint8_t cSaturday = (1<<6); ///< The mask for Saturday.
+    static constexpr uint8_t cEveryDay = 0x7f; ///< The mask for all days.
+
+    static constexpr uint16_t cSunrise = 0x8000; ///< The time of the sunrise.
+    static constexpr uint16_t cSunset = 0x8001; ///< The time of the sunset.
+
+    /// Get the minute of the day for a time, to be used in a rule.
+    ///
+    static constexpr uint16_t time(uint8_t hour, uint8_t minute = 0) {
+        return static_cast<uint16_t>(hour) * 60 + minute;
+    }
+
+    uint8_t weekdays; ///< The mask with the weekdays.
+    uint16_t dateBegin; ///< The first date of the range.
+    uint16_t dateEnd; ///< The last date of the range.
+    uint16_t timeBegin; ///< The first minute of the time window, 0-1439, or a solar event.
+    uint16_t timeEnd; ///< The first minute after the time window, 1-1440, or a solar event.
+    Action action; ///< The action if this rule matches.
+};
+
+
+/// A schedule for the decoration, defined by a table of rules.
+///
+/// The state at a given time is the action of the last matching rule,
+/// so later rules override earlier ones, e.g. for holidays. If no rule
+/// matches, the decoration is off.
+///
+/// The state can only change at the begin or end of a time window or at
+/// midnight. Therefore the next transition can be calculated in advance.
+///
+class Schedule
+{
+public:
+    /// The number of days to search for the next transition.
+    ///
+    static constexpr uint16_t cSearchDays = 367;
+
+public:
+    /// Create a new schedule.
+    ///
+    /// @param rules The table with the rules. It has to exist as long as the schedule.
+    /// @param ruleCount The number of rules in the table.
+    ///
+    Schedule(const ScheduleRule *rules, uint8_t ruleCount);
+
+public:
+    /// Set the table with the sunrise and sunset times.
+    ///
+    /// Without solar table, time windows with solar events never match.
+    ///
+    /// @param sunrise The minute of the sunrise for each day of the year, see `SolarTable`.
+    /// @param sunset The minute of the sunset for each day of the year, see `SolarTable`.
+    ///
+    void setSolarTable(const uint16_t *sunrise, const uint16_t *sunset);
+
+    /// Set the time zone for the solar events.
+    ///
+    /// The solar table is in local standard time. With a time zone, the solar
+    /// events are moved by the daylight saving offset on days with daylight
+    /// saving time. The rules are always evaluated in local time.
+    ///
+    /// @param timeZone The time zone. It has to exist as long as the schedule.
+    ///
+    void setTimeZone(const TimeZone *timeZone);
+
+    /// Check if the decoration is on at the given date/time.
+    ///
+    bool isOn(const DateTime &dateTime) const;
+
+    /// Calculate the next time the state of the schedule changes.
+    ///
+    /// @param now The current date/time.
+    /// @return The date/time of the next change, always after `now`. If the state
+    ///    does not change within `cSearchDays`, the end of this search is returned.
+    ///
+    DateTime nextTransition(const DateTime &now) const;
+
+private:
+    /// The values of a day, which are required to evaluate the rules.
+    ///
+    struct Day {
+        Day(const DateTime &dateTime, const TimeZone *timeZone);
+        uint16_t date; ///< The date as `month*100+day`.
+        uint16_t dayOfYear; ///< The day of the year.
+        uint8_t weekdayMask; ///< The mask for the weekday.
+        uint16_t previousDate; ///< The date of the previous day, for windows over midnight.
+        uint8_t previousWeekdayMask; ///< The weekday mask of the previous day.
+        uint8_t solarShift; ///< The minutes to add to the solar events.
+    };
+
+    /// Check if the decoration is on.
+    ///
+    bool isOn(const Day &day, uint16_t minuteOfDay) const;
+
+    /// Check if the weekday and date of a rule match.
+    ///
+    static bool isDayMatch(const ScheduleRule &rule, uint16_t date, uint8_t weekdayMask);
+
+    /// Get the next minute after the given one, where a rule begins or ends.
+    ///
+    /// @return The next minute, or 1440 if there is none on this day.
+    ///
+    uint16_t getNextBoundary(const Day &day, uint16_t minuteOfDay) const;
+
+    /// Get the minute of the day for a time of a rule.
+    ///
+    uint16_t getMinuteOfDay(const Day &day, uint16_t time) const;
+
+private:
+    const ScheduleRule *_rules; ///< The table with the rules.
+    uint8_t _ruleCount; ///< The number of rules.
+    const uint16_t *_sunrise; ///< The sunrise for each day of the year, or nullptr.
+    const uint16_t *_sunset; ///< The sunset for each day of the year, or nullptr.
+    const TimeZone *_timeZone; ///< The time zone for the solar events, or nullptr.
+};
+
+
+}
+
+
@@ -0,0 +1,143 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "ConstMath.hpp"
+
+#include <cstdint>
+
+
+namespace lr {
+
+
+/// @internal
+/// The calculation of sunrise and sunset for one day.
+///
+/// Using the equations of the NOAA Global Monitoring Division:
+/// https://gml.noaa.gov/grad/solcalc/solareqns.PDF
+///
+namespace SolarCalculation {
+
+/// The fractional year in radians for the noon of a day.
+constexpr double fractionalYear(uint16_t dayOfYear)
+{
+    return 2.0 * ConstMath::cPi / 365.0 * dayOfYear;
+}
+
+/// The equation of time in minutes.
+constexpr double equationOfTime(double year)
+{
+    return 229.18 * (0.000075 + 0.001868 * ConstMath::cos(year) - 0.032077 * ConstMath::sin(year)
+        - 0.014615 * ConstMath::cos(2.0 * year) - 0.040849 * ConstMath::sin(2.0 * year));
+}
+
+/// The declination of the sun in radians.
+constexpr double declination(double year)
+{
+    return 0.006918 - 0.399912 * ConstMath::cos(year) + 0.070257 * ConstMath::sin(year)
+        - 0.006758 * ConstMath::cos(2.0 * year) + 0.000907 * ConstMath::sin(2.0 * year)
+        - 0.002697 * ConstMath::cos(3.0 * year) + 0.00148 * ConstMath::sin(3.0 * year);
+}
+
+/// Convert degrees to radians.
+constexpr double radians(double degrees)
+{
+    return degrees * ConstMath::cPi / 180.0;
+}
+
+/// The hour angle of the sunrise in degrees, zero for polar night and 180 for polar day.
+constexpr double hourAngle(double latitude, double declination)
+{
+    return ConstMath::acos(ConstMath::cos(radians(90.833)) / (ConstMath::cos(latitude) * ConstMath::cos(declination))
+        - ConstMath::tan(latitude) * ConstMath::tan(declination)) * 180.0 / ConstMath::cPi;
+}
+
+/// Limit a time to the minutes of a day.
+constexpr uint16_t limitMinute(double minute)
+{
+    return minute < 0.0 ? 0 : (minute > 1439.0 ? 1439 : static_cast<uint16_t>(ConstMath::round(minute)));
+}
+
+/// The minute of the day for the sunrise or sunset.
+///
+/// @param dayOfYear The day of the year, starting with 0.
+/// @param latitude The latitude in degrees.
+/// @param longitude The longitude in degrees, positive values east.
+/// @param utcOffset The offset of the local standard time in minutes.
+/// @param direction -1 for the sunrise, +1 for the sunset.
+///
+constexpr uint16_t eventMinute(uint16_t dayOfYear, double latitude, double longitude, int16_t utcOffset, int8_t direction)
+{
+    return limitMinute(720.0 - 4.0 * (longitude - direction * hourAngle(radians(latitude), declination(fractionalYear(dayOfYear))))
+        - equationOfTime(fractionalYear(dayOfYear)) + utcOffset);
+}
+
+}
+
+
+/// @internal
+/// The storage for a solar table, expanded from an index list.
+///
+template<int16_t tLatitude, int16_t tLongitude, int16_t tUtcOffset, typename tIndexList>
+struct SolarTableData;
+
+template<int16_t tLatitude, int16_t tLongitude, int16_t tUtcOffset, uint16_t... tIndex>
+struct SolarTableData<tLatitude, tLongitude, tUtcOffset, ConstMath::IndexList<tIndex...>> {
+    static constexpr uint16_t cSunrise[366] = {
+        SolarCalculation::eventMinute(tIndex, tLatitude / 100.0, tLongitude / 100.0, tUtcOffset, -1)... };
+    static constexpr uint16_t cSunset[366] = {
+        SolarCalculation::eventMinute(tIndex, tLatitude / 100.0, tLongitude / 100.0, tUtcOffset, 1)... };
+};
+
+template<int16_t tLatitude, int16_t tLongitude, int16_t tUtcOffset, uint16_t... tIndex>
+constexpr uint16_t SolarTableData<tLatitude, tLongitude, tUtcOffset, ConstMath::IndexList<tIndex...>>::cSunrise[366];
+
+template<int16_t tLatitude, int16_t tLongitude, int16_t tUtcOffset, uint16_t... tIndex>
+constexpr uint16_t SolarTableData<tLatitude, tLongitude, tUtcOffset, ConstMath::IndexList<tIndex...>>::cSunset[366];
+
+
+/// A table with the sunrise and sunset for each day of the year.
+///
+/// The tables are calculated by the compiler and placed in flash memory.
+/// At runtime, a lookup is a single array access without any floating
+/// point math. The values are the minute of the day in local standard
+/// time, indexed with `DateTime::getDayOfYear()`. In polar regions, the
+/// values are limited to the day, e.g. sunrise and sunset are both at noon
+/// during the polar night.
+///
+/// The compiler evaluates the trigonometric functions with series. Every
+/// value is within one minute of the same equations calculated with the
+/// standard math library, see `test/SolarTableTest.cpp`.
+///
+/// Example: `SolarTable<4737, 854, 60>` for Zurich in central european time.
+///
+/// @tparam tLatitude The latitude in hundredths of a degree, positive values north.
+/// @tparam tLongitude The longitude in hundredths of a degree, positive values east.
+/// @tparam tUtcOffset The offset of the local standard time to UTC in minutes.
+///
+template<int16_t tLatitude, int16_t tLongitude, int16_t tUtcOffset>
+struct SolarTable : SolarTableData<tLatitude, tLongitude, tUtcOffset, typename ConstMath::MakeIndexList<366>::Type> {
+    static_assert(tLatitude >= -9000 && tLatitude <= 9000, "The latitude has to be in the range -90 to 90 degrees.");
+    static_assert(tLongitude >= -18000 && tLongitude <= 18000, "The longitude has to be in the range -180 to 180 degrees.");
+};
+
+
+}
+
+
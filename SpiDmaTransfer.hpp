@@ -0,0 +1,55 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "NeoPixelEncoder.hpp"
+#include "PixelTransfer.hpp"
+
+#include <Arduino.h>
+#include <SPI.h>
+
+
+/// A pixel transfer using the DMA transfers of the SPI library in the Adafruit SAMD core.
+///
+/// The data line is connected to MOSI. On the Trinket M0, the MISO pin is
+/// shared with the SCL line of the I2C bus, so this transfer can not be
+/// used together with the RTC on this board.
+///
+template<NeoPixelEncoder::Encoding tEncoding>
+class SpiDmaTransfer : public PixelTransfer
+{
+public:
+    /// Initialize the SPI bus for the transfer.
+    ///
+    void begin() {
+        SPI.begin();
+        SPI.beginTransaction(SPISettings(NeoPixelEncoder::getSpiClock(tEncoding), MSBFIRST, SPI_MODE0));
+    }
+
+public: // Implement PixelTransfer
+    bool isBusy() const override {
+        return SPI.isBusy();
+    }
+
+    void start(const uint8_t *data, size_t size) override {
+        SPI.transfer(data, nullptr, size, false);
+    }
+};
+
+
@@ -0,0 +1,77 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "NeoPixelEncoder.hpp"
+#include "PixelTransfer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+
+/// A double buffered pixel output using an encoded SPI waveform.
+///
+/// A frame is encoded into the back buffer while the front buffer is
+/// still sent by the transfer. This way the next frame is computed
+/// with interrupts enabled, while the last one is sent.
+///
+/// @tparam tByteCount The number of bytes in the pixel buffer.
+/// @tparam tEncoding The encoding for the waveform.
+///
+template<size_t tByteCount, NeoPixelEncoder::Encoding tEncoding>
+class SpiPixelOutput
+{
+public:
+    /// The size of one encoded frame.
+    ///
+    static constexpr size_t cEncodedSize = NeoPixelEncoder::getEncodedSize(tEncoding, tByteCount);
+
+public:
+    /// Create a new output with the given transfer.
+    ///
+    explicit SpiPixelOutput(PixelTransfer *transfer)
+        : _transfer(transfer), _backBuffer(0) {
+    }
+
+public:
+    /// Encode and send a frame.
+    ///
+    /// Waits only if the previous frame is still in transfer after encoding.
+    ///
+    /// @param pixels The pixel buffer in wire order.
+    ///
+    void show(const uint8_t *pixels) {
+        uint8_t *buffer = _buffers[_backBuffer];
+        NeoPixelEncoder::encode(tEncoding, pixels, tByteCount, buffer);
+        while (_transfer->isBusy()) {
+        }
+        _transfer->start(buffer, cEncodedSize);
+        _backBuffer ^= 1;
+    }
+
+private:
+    PixelTransfer *_transfer; ///< The transfer for the encoded frames.
+    uint8_t _buffers[2][cEncodedSize]; ///< The front and back buffer.
+    uint8_t _backBuffer; ///< The index of the back buffer.
+};
+
+template<size_t tByteCount, NeoPixelEncoder::Encoding tEncoding>
+constexpr size_t SpiPixelOutput<tByteCount, tEncoding>::cEncodedSize;
+
+
@@ -0,0 +1,127 @@
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "SystemClock.hpp"
+
+
+namespace lr {
+
+
+constexpr uint32_t SystemClock::cDefaultSynchronizationInterval;
+constexpr int32_t SystemClock::cMaximumDrift;
+constexpr uint32_t SystemClock::cMinimumCalibrationTime;
+
+
+SystemClock::SystemClock()
+    : _synchronizationInterval(cDefaultSynchronizationInterval),
+    _synchronizationSeconds(0),
+    _synchronizationMilliseconds(0),
+    _calibrationSeconds(0),
+    _calibrationMilliseconds(0),
+    _drift(0),
+    _isSynchronized(false),
+    _cachedSeconds(0),
+    _cachedDateTime()
+{
+}
+
+
+void SystemClock::setSynchronizationInterval(uint32_t interval)
+{
+    _synchronizationInterval = interval;
+}
+
+
+bool SystemClock::isSynchronized() const
+{
+    return _isSynchronized;
+}
+
+
+bool SystemClock::isSynchronizationRequired(uint32_t milliseconds) const
+{
+    return !_isSynchronized || (milliseconds - _synchronizationMilliseconds) >= _synchronizationInterval;
+}
+
+
+void SystemClock::synchronize(const DateTime &dateTime, uint32_t milliseconds)
+{
+    const uint32_t seconds = dateTime.toSecondsSince2000();
+    if (!_isSynchronized) {
+        restartCalibration(seconds, milliseconds);
+    } else {
+        // A larger difference than the maximum drift is a change of the real time clock.
+        const uint32_t elapsed = milliseconds - _synchronizationMilliseconds;
+        const int32_t difference = static_cast<int32_t>(seconds - getSecondsSince2000(milliseconds));
+        const int32_t maximumDifference = static_cast<int32_t>(
+            static_cast<uint64_t>(elapsed) * cMaximumDrift / 1000000000u) + 2;
+        const uint32_t calibrationTime = milliseconds - _calibrationMilliseconds;
+        if (difference > maximumDifference || difference < -maximumDifference || calibrationTime >= 0x80000000u) {
+            restartCalibration(seconds, milliseconds);
+        } else if (calibrationTime >= cMinimumCalibrationTime) {
+            // Measure the drift over the whole calibration time, to reduce the error of the resolution.
+            const int64_t realTime = static_cast<int64_t>(seconds - _calibrationSeconds) * 1000;
+            const int64_t drift = (realTime - calibrationTime) * 1000000 / calibrationTime;
+            if (drift <= cMaximumDrift && drift >= -cMaximumDrift) {
+                _drift = static_cast<int32_t>(drift);
+            }
+        }
+    }
+    _synchronizationSeconds = seconds;
+    _synchronizationMilliseconds = milliseconds;
+    _isSynchronized = true;
+}
+
+
+uint32_t SystemClock::getSecondsSince2000(uint32_t milliseconds) const
+{
+    // The real time clock is read at an unknown fraction of the second, assume the middle.
+    const int64_t elapsed = milliseconds - _synchronizationMilliseconds;
+    const int64_t corrected = elapsed + elapsed * _drift / 1000000 + 500;
+    return _synchronizationSeconds + static_cast<uint32_t>(corrected / 1000);
+}
+
+
+const DateTime& SystemClock::getDateTime(uint32_t milliseconds)
+{
+    const uint32_t seconds = getSecondsSince2000(milliseconds);
+    if (seconds != _cachedSeconds) {
+        if (seconds > _cachedSeconds && seconds - _cachedSeconds < 86400) {
+            _cachedDateTime.advanceSeconds(seconds - _cachedSeconds);
+        } else {
+            _cachedDateTime = DateTime::fromSecondsSince2000(seconds);
+        }
+        _cachedSeconds = seconds;
+    }
+    return _cachedDateTime;
+}
+
+
+int32_t SystemClock::getDrift() const
+{
+    return _drift;
+}
+
+
+void SystemClock::restartCalibration(uint32_t seconds, uint32_t milliseconds)
+{
+    _calibrationSeconds = seconds;
+    _calibrationMilliseconds = milliseconds;
+}
+
+
+}
@@ -0,0 +1,132 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "DateTime.hpp"
+
+#include <cstdint>
+
+
+namespace lr {
+
+
+/// A software clock, extrapolated from the millisecond counter of the CPU.
+///
+/// The clock is synchronized with the real time clock from time to time,
+/// and extrapolated with `millis()` in between. On each synchronization,
+/// the drift of the CPU clock against the real time clock is measured,
+/// over the whole time since the calibration started. The extrapolation
+/// corrects this drift, so the synchronization interval can be long.
+///
+/// All functions take the current milliseconds as argument, so the clock
+/// does not depend on the hardware.
+///
+class SystemClock
+{
+public:
+    /// The default interval between two synchronizations in milliseconds.
+    ///
+    static constexpr uint32_t cDefaultSynchronizationInterval = 21600000;
+
+    /// The maximum drift of the CPU clock in parts per million.
+    ///
+    /// A larger difference is considered as a change of the real time clock,
+    /// and the calibration restarts.
+    ///
+    static constexpr int32_t cMaximumDrift = 5000;
+
+    /// The minimum calibration time in milliseconds to measure the drift.
+    ///
+    /// The real time clock has a resolution of one second, so a measurement
+    /// can be up to one second off. After four hours, this is an error of
+    /// at most 70 ppm, which shrinks as the calibration continues.
+    ///
+    static constexpr uint32_t cMinimumCalibrationTime = 14400000;
+
+public:
+    /// Create a new clock, which is not synchronized.
+    ///
+    SystemClock();
+
+public:
+    /// Set the interval between two synchronizations.
+    ///
+    /// @param interval The interval in milliseconds.
+    ///
+    void setSynchronizationInterval(uint32_t interval);
+
+    /// Check if the clock was synchronized at least once.
+    ///
+    bool isSynchronized() const;
+
+    /// Check if the clock should be synchronized.
+    ///
+    /// @param milliseconds The current value of `millis()`.
+    ///
+    bool isSynchronizationRequired(uint32_t milliseconds) const;
+
+    /// Synchronize the clock with the real time clock.
+    ///
+    /// @param dateTime The date/time read from the real time clock.
+    /// @param milliseconds The value of `millis()` when the time was read.
+    ///
+    void synchronize(const DateTime &dateTime, uint32_t milliseconds);
+
+    /// Get the current time in seconds since 2000-01-01 00:00:00.
+    ///
+    /// @param milliseconds The current value of `millis()`.
+    ///
+    uint32_t getSecondsSince2000(uint32_t milliseconds) const;
+
+    /// Get the current date/time.
+    ///
+    /// The last result is cached, so for calls within the same second this is
+    /// a compare, and for following seconds only the time is advanced.
+    ///
+    /// @param milliseconds The current value of `millis()`.
+    ///
+    const DateTime& getDateTime(uint32_t milliseconds);
+
+    /// Get the measured drift of the CPU clock.
+    ///
+    /// @return The drift in parts per million, positive if the CPU clock is too slow.
+    ///
+    int32_t getDrift() const;
+
+private:
+    /// Restart the drift calibration at the given point in time.
+    ///
+    void restartCalibration(uint32_t seconds, uint32_t milliseconds);
+
+private:
+    uint32_t _synchronizationInterval; ///< The interval between synchronizations in milliseconds.
+    uint32_t _synchronizationSeconds; ///< The seconds of the last synchronization.
+    uint32_t _synchronizationMilliseconds; ///< The milliseconds of the last synchronization.
+    uint32_t _calibrationSeconds; ///< The seconds at the start of the calibration.
+    uint32_t _calibrationMilliseconds; ///< The milliseconds at the start of the calibration.
+    int32_t _drift; ///< The drift of the CPU clock in parts per million.
+    bool _isSynchronized; ///< If the clock was synchronized at least once.
+    uint32_t _cachedSeconds; ///< The seconds of the cached date/time.
+    DateTime _cachedDateTime; ///< The last returned date/time.
+};
+
+
+}
+
+
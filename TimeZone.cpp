@@ -0,0 +1,108 @@
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "TimeZone.hpp"
+
+
+namespace lr {
+
+
+constexpr int16_t TimeZone::cDaylightSavingOffset;
+
+
+TimeZone::TimeZone(int16_t standardOffset, const uint32_t *transitions, uint8_t transitionCount)
+    : _standardOffset(standardOffset), _transitions(transitions), _transitionCount(transitions != nullptr ? transitionCount : 0)
+{
+}
+
+
+int32_t TimeZone::getOffset(uint32_t utcSeconds) const
+{
+    int32_t offset = static_cast<int32_t>(_standardOffset) * 60;
+    if ((getTransitionIndex(utcSeconds) & 1) != 0) {
+        offset += static_cast<int32_t>(cDaylightSavingOffset) * 60;
+    }
+    return offset;
+}
+
+
+bool TimeZone::isDaylightSaving(const DateTime &utc) const
+{
+    return (getTransitionIndex(utc.toSecondsSince2000()) & 1) != 0;
+}
+
+
+DateTime TimeZone::toLocal(const DateTime &utc) const
+{
+    return utc.addSeconds(getOffset(utc.toSecondsSince2000()));
+}
+
+
+DateTime TimeZone::toUtc(const DateTime &local) const
+{
+    // Assume daylight saving time first, to prefer the first of two equal local times.
+    const uint32_t standardSeconds = local.toSecondsSince2000() - static_cast<int32_t>(_standardOffset) * 60;
+    const uint32_t daylightSeconds = standardSeconds - static_cast<int32_t>(cDaylightSavingOffset) * 60;
+    if ((getTransitionIndex(daylightSeconds) & 1) != 0) {
+        return DateTime::fromSecondsSince2000(daylightSeconds);
+    }
+    return DateTime::fromSecondsSince2000(standardSeconds);
+}
+
+
+DateTime TimeZone::toUtcAfter(const DateTime &local, const DateTime &utc) const
+{
+    const uint32_t utcSeconds = utc.toSecondsSince2000();
+    const uint32_t standardSeconds = local.toSecondsSince2000() - static_cast<int32_t>(_standardOffset) * 60;
+    const uint32_t daylightSeconds = standardSeconds - static_cast<int32_t>(cDaylightSavingOffset) * 60;
+    if ((getTransitionIndex(daylightSeconds) & 1) != 0 && daylightSeconds > utcSeconds) {
+        return DateTime::fromSecondsSince2000(daylightSeconds);
+    }
+    if ((getTransitionIndex(standardSeconds) & 1) == 0 && standardSeconds > utcSeconds) {
+        return DateTime::fromSecondsSince2000(standardSeconds);
+    }
+    return toUtc(local);
+}
+
+
+uint32_t TimeZone::getNextTransition(const DateTime &utc) const
+{
+    const uint8_t index = getTransitionIndex(utc.toSecondsSince2000());
+    if (index >= _transitionCount) {
+        return 0xffffffffu;
+    }
+    return _transitions[index];
+}
+
+
+uint8_t TimeZone::getTransitionIndex(uint32_t utcSeconds) const
+{
+    uint8_t begin = 0;
+    uint8_t end = _transitionCount;
+    while (begin < end) {
+        const uint8_t middle = (begin + end) / 2;
+        if (_transitions[middle] <= utcSeconds) {
+            begin = middle + 1;
+        } else {
+            end = middle;
+        }
+    }
+    return begin;
+}
+
+
+}
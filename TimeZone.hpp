@@ -0,0 +1,257 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "ConstMath.hpp"
+#include "DateTime.hpp"
+
+#include <cstdint>
+
+
+namespace lr {
+
+
+/// The rule for the daylight saving time.
+///
+enum class DaylightSavingRule : uint8_t {
+    European, ///< From the last Sunday in March to the last Sunday in October, at 01:00 UTC.
+    NorthAmerican, ///< From the second Sunday in March to the first Sunday in November, at 02:00 local time.
+};
+
+
+/// @internal
+/// The calculation of the daylight saving transitions.
+///
+namespace TimeZoneCalculation {
+
+/// The number of seconds per day.
+constexpr uint32_t cSecondsPerDay = 86400;
+
+/// The year for the days calculation, counted from March.
+constexpr uint32_t shiftedYear(uint16_t year, uint8_t month)
+{
+    return static_cast<uint32_t>(year) - (month <= 2 ? 1 : 0);
+}
+
+/// The day in the year counted from March, 0-365.
+constexpr uint32_t shiftedDayOfYear(uint8_t month, uint8_t day)
+{
+    return (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+}
+
+/// The day in the 400 year era, 0-146096.
+constexpr uint32_t dayOfEra(uint32_t yearOfEra, uint32_t dayOfYear)
+{
+    return yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+}
+
+/// The number of days since 2000-01-01, see `DateTime::toSecondsSince2000()`.
+constexpr uint32_t daysSince2000(uint16_t year, uint8_t month, uint8_t day)
+{
+    return shiftedYear(year, month) / 400 * 146097
+        + dayOfEra(shiftedYear(year, month) % 400, shiftedDayOfYear(month, day)) - 730425;
+}
+
+/// The day of the week for a day since 2000-01-01, 0=Sunday.
+constexpr uint32_t dayOfWeek(uint32_t days)
+{
+    return (days + 6) % 7; // 2000-01-01 was Saturday (6)
+}
+
+/// The day of the last Sunday in a month.
+constexpr uint32_t lastSundayFrom(uint32_t lastDay)
+{
+    return lastDay - dayOfWeek(lastDay);
+}
+
+/// The day of the last Sunday in a month.
+constexpr uint32_t lastSunday(uint16_t year, uint8_t month)
+{
+    return lastSundayFrom(daysSince2000(month == 12 ? year + 1 : year, month == 12 ? 1 : month + 1, 1) - 1);
+}
+
+/// The day of the first Sunday on or after the given day.
+constexpr uint32_t firstSundayFrom(uint32_t firstDay)
+{
+    return firstDay + (7 - dayOfWeek(firstDay)) % 7;
+}
+
+/// The day of the n-th Sunday in a month, starting with 1.
+constexpr uint32_t nthSunday(uint16_t year, uint8_t month, uint8_t n)
+{
+    return firstSundayFrom(daysSince2000(year, month, 1)) + 7 * (n - 1);
+}
+
+/// The begin of the daylight saving time in seconds since 2000-01-01 00:00:00 UTC.
+constexpr uint32_t beginOfDaylightSaving(DaylightSavingRule rule, uint16_t year, int16_t standardOffset)
+{
+    return rule == DaylightSavingRule::European
+        ? lastSunday(year, 3) * cSecondsPerDay + 3600
+        : nthSunday(year, 3, 2) * cSecondsPerDay + 7200 - standardOffset * 60;
+}
+
+/// The end of the daylight saving time in seconds since 2000-01-01 00:00:00 UTC.
+constexpr uint32_t endOfDaylightSaving(DaylightSavingRule rule, uint16_t year, int16_t standardOffset)
+{
+    return rule == DaylightSavingRule::European
+        ? lastSunday(year, 10) * cSecondsPerDay + 3600
+        : nthSunday(year, 11, 1) * cSecondsPerDay + 7200 - (standardOffset + 60) * 60;
+}
+
+/// The transition with the given index. Even indexes begin, odd indexes end the daylight saving time.
+constexpr uint32_t transition(DaylightSavingRule rule, uint16_t firstYear, int16_t standardOffset, uint16_t index)
+{
+    return (index & 1) == 0
+        ? beginOfDaylightSaving(rule, firstYear + index / 2, standardOffset)
+        : endOfDaylightSaving(rule, firstYear + index / 2, standardOffset);
+}
+
+}
+
+
+/// @internal
+/// The storage for a transition table, expanded from an index list.
+///
+template<int16_t tStandardOffset, DaylightSavingRule tRule, uint16_t tFirstYear, typename tIndexList>
+struct TimeZoneTableData;
+
+template<int16_t tStandardOffset, DaylightSavingRule tRule, uint16_t tFirstYear, uint16_t... tIndex>
+struct TimeZoneTableData<tStandardOffset, tRule, tFirstYear, ConstMath::IndexList<tIndex...>> {
+    static constexpr uint32_t cTransitions[sizeof...(tIndex)] = {
+        TimeZoneCalculation::transition(tRule, tFirstYear, tStandardOffset, tIndex)... };
+};
+
+template<int16_t tStandardOffset, DaylightSavingRule tRule, uint16_t tFirstYear, uint16_t... tIndex>
+constexpr uint32_t TimeZoneTableData<tStandardOffset, tRule, tFirstYear, ConstMath::IndexList<tIndex...>>::cTransitions[sizeof...(tIndex)];
+
+
+/// A table with the daylight saving transitions of a time zone.
+///
+/// The table is calculated by the compiler and placed in flash memory.
+/// The transitions are in seconds since 2000-01-01 00:00:00 UTC and
+/// alternate between the begin and end of the daylight saving time.
+/// The daylight saving time is always one hour.
+///
+/// Example: `TimeZoneTable<60, DaylightSavingRule::European>` for central european time.
+///
+/// @tparam tStandardOffset The offset of the local standard time to UTC in minutes.
+/// @tparam tRule The rule for the daylight saving time.
+/// @tparam tFirstYear The first year in the table.
+/// @tparam tYearCount The number of years in the table.
+///
+template<int16_t tStandardOffset, DaylightSavingRule tRule, uint16_t tFirstYear = 2020, uint8_t tYearCount = 50>
+struct TimeZoneTable : TimeZoneTableData<tStandardOffset, tRule, tFirstYear,
+    typename ConstMath::MakeIndexList<tYearCount * 2>::Type> {
+    static_assert(tStandardOffset >= -720 && tStandardOffset <= 840, "The offset has to be in the range -12 to +14 hours.");
+    static_assert(tFirstYear >= 2001 && tFirstYear + tYearCount <= 2135, "The years have to be in the range 2001 to 2135.");
+    static_assert(tYearCount > 0 && tYearCount <= 127, "The table needs 1 to 127 years.");
+
+    static constexpr int16_t cStandardOffset = tStandardOffset; ///< The offset of the standard time in minutes.
+    static constexpr uint8_t cTransitionCount = tYearCount * 2; ///< The number of transitions in the table.
+};
+
+template<int16_t tStandardOffset, DaylightSavingRule tRule, uint16_t tFirstYear, uint8_t tYearCount>
+constexpr int16_t TimeZoneTable<tStandardOffset, tRule, tFirstYear, tYearCount>::cStandardOffset;
+
+template<int16_t tStandardOffset, DaylightSavingRule tRule, uint16_t tFirstYear, uint8_t tYearCount>
+constexpr uint8_t TimeZoneTable<tStandardOffset, tRule, tFirstYear, tYearCount>::cTransitionCount;
+
+
+/// A time zone to convert between UTC and local time.
+///
+/// The real time clock keeps UTC, which never jumps. To get the local time,
+/// the time zone searches the transition table with a binary search and
+/// adds the offset. No calendar rules are evaluated at runtime.
+///
+class TimeZone
+{
+public:
+    /// The offset of the daylight saving time to the standard time in minutes.
+    ///
+    static constexpr int16_t cDaylightSavingOffset = 60;
+
+public:
+    /// Create a new time zone.
+    ///
+    /// @param standardOffset The offset of the local standard time to UTC in minutes.
+    /// @param transitions The sorted transitions in seconds since 2000-01-01 UTC, alternating
+    ///    between the begin and end of the daylight saving time, see `TimeZoneTable`.
+    ///    Use `nullptr` for a time zone without daylight saving time. The table has to
+    ///    exist as long as the time zone.
+    /// @param transitionCount The number of transitions in the table.
+    ///
+    explicit TimeZone(int16_t standardOffset, const uint32_t *transitions = nullptr, uint8_t transitionCount = 0);
+
+public:
+    /// Get the offset of the local time to UTC in seconds.
+    ///
+    /// @param utcSeconds The time in seconds since 2000-01-01 00:00:00 UTC.
+    ///
+    int32_t getOffset(uint32_t utcSeconds) const;
+
+    /// Check if the daylight saving time is active at the given UTC date/time.
+    ///
+    bool isDaylightSaving(const DateTime &utc) const;
+
+    /// Convert UTC into the local time.
+    ///
+    DateTime toLocal(const DateTime &utc) const;
+
+    /// Convert the local time into UTC.
+    ///
+    /// If the local time exists twice, at the end of the daylight saving time,
+    /// the first one is used. A local time which is skipped at the begin of the
+    /// daylight saving time is interpreted as standard time.
+    ///
+    DateTime toUtc(const DateTime &local) const;
+
+    /// Convert the local time into the first matching UTC time after a given time.
+    ///
+    /// If the local time exists twice, the second one is used if the first one
+    /// is not after `utc`. This is required for times in the future, like the
+    /// next check of a schedule in the repeated hour at the end of the daylight
+    /// saving time. If no interpretation is after `utc`, this is the same as `toUtc()`.
+    ///
+    /// @param local The local time to convert.
+    /// @param utc The UTC time the result has to be after.
+    ///
+    DateTime toUtcAfter(const DateTime &local, const DateTime &utc) const;
+
+    /// Get the next transition after the given UTC date/time.
+    ///
+    /// @return The next transition, in seconds since 2000-01-01 00:00:00 UTC,
+    ///    or `0xffffffff` if there is none in the table.
+    ///
+    uint32_t getNextTransition(const DateTime &utc) const;
+
+private:
+    /// Get the number of transitions at or before the given time.
+    ///
+    uint8_t getTransitionIndex(uint32_t utcSeconds) const;
+
+private:
+    int16_t _standardOffset; ///< The offset of the standard time in minutes.
+    const uint32_t *_transitions; ///< The table with the transitions, or nullptr.
+    uint8_t _transitionCount; ///< The number of transitions.
+};
+
+
+}
+
+
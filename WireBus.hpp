@@ -0,0 +1,72 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "I2cBus.hpp"
+
+#include <Wire.h>
+
+
+namespace lr {
+
+
+/// The I2C bus implementation using the `Wire` library.
+///
+class WireBus : public I2cBus
+{
+public:
+    /// Create a bus for the given `Wire` object.
+    ///
+    explicit WireBus(TwoWire &wire = Wire)
+        : _wire(wire) {
+    }
+
+public: // Implement I2cBus
+    bool writeRegisters(uint8_t address, uint8_t firstRegister, const uint8_t *data, uint8_t count) override {
+        _wire.beginTransmission(address);
+        _wire.write(firstRegister);
+        for (uint8_t i = 0; i < count; ++i) {
+            _wire.write(data[i]);
+        }
+        return _wire.endTransmission() == 0;
+    }
+
+    bool readRegisters(uint8_t address, uint8_t firstRegister, uint8_t *data, uint8_t count) override {
+        // Address the register.
+        _wire.beginTransmission(address);
+        _wire.write(firstRegister);
+        if (_wire.endTransmission() != 0) {
+            return false;
+        }
+        // Read the register values.
+        const bool success = (_wire.requestFrom(address, static_cast<size_t>(count)) == count);
+        for (uint8_t i = 0; i < count; ++i) {
+            data[i] = static_cast<uint8_t>(_wire.read());
+        }
+        return success;
+    }
+
+private:
+    TwoWire &_wire; ///< The wire object for the bus.
+};
+
+
+}
+
+
@@ -0,0 +1,278 @@
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Test.hpp"
+
+#include "DateTime.hpp"
+
+
+/// @file
+/// Compares the calendar conversions with the former loop based implementation.
+
+
+namespace {
+
+
+using lr::DateTime;
+
+
+/// The former implementation, kept as reference.
+///
+namespace reference {
+
+
+const uint8_t cDaysPerMonth[] = {0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+const uint32_t cSecondsPerDay = 86400;
+
+
+struct Fields
+{
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint8_t dayOfWeek;
+};
+
+
+uint8_t calculateDayOfWeek(int16_t year, int16_t month, int16_t day)
+{
+    const int16_t a = ((14 - month) / 12);
+    const int16_t y = year - a;
+    const int16_t m = month + (12 * a) - 2;
+    const int16_t d = (day + y + (y/4) - (y/100) + (y/400) + ((31 * m)/12)) % 7;
+    return d;
+}
+
+
+bool isLeapYear(uint16_t year)
+{
+    return ((year&3) == 0 && year%100 != 0) || (year%400 == 0);
+}
+
+
+uint8_t getMaxDayPerMonth(uint16_t year, uint8_t month)
+{
+    if (month == 2 && isLeapYear(year)) {
+        return 29;
+    }
+    return cDaysPerMonth[month];
+}
+
+
+uint32_t getDaysForYear(uint16_t year)
+{
+    return isLeapYear(year) ? 366 : 365;
+}
+
+
+Fields setDate(uint16_t year, uint16_t month, uint16_t day)
+{
+    Fields fields = {};
+    fields.year = (year < 2000) ? 2000 : ((year > 9999) ? 9999 : year);
+    fields.month = (month < 1) ? 1 : ((month > 12) ? 12 : month);
+    const uint8_t maxDayPerMonth = getMaxDayPerMonth(fields.year, fields.month);
+    fields.day = (day < 1) ? 1 : ((day > maxDayPerMonth) ? maxDayPerMonth : day);
+    fields.dayOfWeek = calculateDayOfWeek(fields.year, fields.month, fields.day);
+    return fields;
+}
+
+
+uint32_t toSecondsSince2000(const Fields &fields)
+{
+    uint32_t seconds = 0;
+    for (uint16_t year = 2000; year < fields.year; ++year) {
+        seconds += getDaysForYear(year) * cSecondsPerDay;
+    }
+    for (uint8_t month = 1; month < fields.month; ++month) {
+        seconds += static_cast<uint32_t>(getMaxDayPerMonth(fields.year, month)) * cSecondsPerDay;
+    }
+    seconds += static_cast<uint32_t>(fields.day-1) * cSecondsPerDay;
+    seconds += static_cast<uint32_t>(fields.hour) * 3600;
+    seconds += static_cast<uint32_t>(fields.minute) * 60;
+    seconds += static_cast<uint32_t>(fields.second);
+    return seconds;
+}
+
+
+Fields fromSecondsSince2000(uint32_t secondsSince2000)
+{
+    Fields fields = {};
+    uint32_t secondsSinceMidnight = secondsSince2000%cSecondsPerDay;
+    fields.hour = secondsSinceMidnight/3600;
+    secondsSinceMidnight %= 3600;
+    fields.minute = secondsSinceMidnight/60;
+    fields.second = secondsSinceMidnight%60;
+    uint32_t days = secondsSince2000/cSecondsPerDay;
+    fields.dayOfWeek = (days+6)%7;
+    uint16_t year = 2000;
+    uint32_t daysForThisSection = getDaysForYear(year);
+    while (days >= daysForThisSection) {
+        ++year;
+        days -= daysForThisSection;
+        daysForThisSection = getDaysForYear(year);
+    }
+    uint8_t month = 1;
+    daysForThisSection = getMaxDayPerMonth(year, month);
+    while (days >= daysForThisSection) {
+        ++month;
+        days -= daysForThisSection;
+        daysForThisSection = getMaxDayPerMonth(year, month);
+    }
+    fields.year = year;
+    fields.month = month;
+    fields.day = days+1;
+    return fields;
+}
+
+
+uint16_t getDayOfYear(const Fields &fields)
+{
+    uint16_t dayOfYear = fields.day - 1;
+    for (uint8_t month = 1; month < fields.month; ++month) {
+        dayOfYear += getMaxDayPerMonth(fields.year, month);
+    }
+    return dayOfYear;
+}
+
+
+}
+
+
+bool isEqual(const DateTime &dateTime, const reference::Fields &fields)
+{
+    return dateTime.getYear() == fields.year
+        && dateTime.getMonth() == fields.month
+        && dateTime.getDay() == fields.day
+        && dateTime.getHour() == fields.hour
+        && dateTime.getMinute() == fields.minute
+        && dateTime.getSecond() == fields.second
+        && dateTime.getDayOfWeek() == fields.dayOfWeek;
+}
+
+
+/// Every day of the 32bit range, at a different time of day.
+///
+void checkSecondsConversion()
+{
+    const uint32_t lastDay = 0xffffffffu / reference::cSecondsPerDay;
+    for (uint32_t day = 0; day <= lastDay; ++day) {
+        const uint32_t secondOfDay = (day * 7919u) % reference::cSecondsPerDay;
+        const uint32_t seconds = day * reference::cSecondsPerDay + secondOfDay;
+        if (day == lastDay && seconds < day * reference::cSecondsPerDay) {
+            break; // The time of day does not fit into 32 bits.
+        }
+        const reference::Fields expected = reference::fromSecondsSince2000(seconds);
+        const DateTime dateTime = DateTime::fromSecondsSince2000(seconds);
+        CHECK(isEqual(dateTime, expected));
+        CHECK(dateTime.toSecondsSince2000() == seconds);
+        CHECK(reference::toSecondsSince2000(expected) == seconds);
+        CHECK(dateTime.getDayOfYear() == reference::getDayOfYear(expected));
+    }
+    CHECK(isEqual(DateTime::fromSecondsSince2000(0xffffffffu), reference::fromSecondsSince2000(0xffffffffu)));
+    CHECK(DateTime::fromSecondsSince2000(0xffffffffu).toSecondsSince2000() == 0xffffffffu);
+}
+
+
+/// Every date from 2000 to 9999, and the clamping of invalid values.
+///
+void checkDates()
+{
+    for (uint16_t year = 2000; year <= 9999; ++year) {
+        for (uint8_t month = 1; month <= 12; ++month) {
+            const uint8_t maxDay = reference::getMaxDayPerMonth(year, month);
+            for (uint8_t day = 1; day <= maxDay; ++day) {
+                const DateTime dateTime(year, month, day, 12, 30, 45);
+                reference::Fields expected = reference::setDate(year, month, day);
+                expected.hour = 12;
+                expected.minute = 30;
+                expected.second = 45;
+                CHECK(isEqual(dateTime, expected));
+                CHECK(dateTime.getDayOfYear() == reference::getDayOfYear(expected));
+            }
+        }
+    }
+    const uint16_t years[] = {0, 1999, 2000, 2100, 2400, 9999, 10000, 0xffff};
+    for (uint16_t year : years) {
+        for (uint8_t month = 0; month <= 13; ++month) {
+            for (uint8_t day = 0; day <= 32; ++day) {
+                const DateTime dateTime(year, month, day);
+                CHECK(isEqual(dateTime, reference::setDate(year, month, day)));
+            }
+        }
+    }
+}
+
+
+/// Advancing matches the conversion from seconds.
+///
+void checkAdvance()
+{
+    uint32_t state = 0x12345678u;
+    for (uint32_t i = 0; i < 1000000; ++i) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        const uint32_t start = state % 0xf0000000u;
+        const uint32_t step = (i % 4 == 0) ? (state >> 4) : ((state >> 8) % (i % 4 == 1 ? 100u : 200000u));
+        DateTime dateTime = DateTime::fromSecondsSince2000(start);
+        dateTime.advanceSeconds(step);
+        CHECK(isEqual(dateTime, reference::fromSecondsSince2000(start + step)));
+        const uint32_t days = step % 1000u;
+        DateTime dateTimeDays = DateTime::fromSecondsSince2000(start);
+        dateTimeDays.advanceDays(days);
+        CHECK(isEqual(dateTimeDays, reference::fromSecondsSince2000(start + days * reference::cSecondsPerDay)));
+    }
+}
+
+
+void benchmarkConversion()
+{
+    const uint32_t cIterations = 200000;
+    const uint32_t cStep = 0xffffffffu / cIterations;
+    const double referenceFromTime = test::measure(cIterations, [](uint32_t i) {
+        test::keep(reference::fromSecondsSince2000(i * cStep));
+    });
+    const double fromTime = test::measure(cIterations, [](uint32_t i) {
+        test::keep(DateTime::fromSecondsSince2000(i * cStep));
+    });
+    const reference::Fields fields = reference::fromSecondsSince2000(0xf0000000u);
+    const DateTime dateTime = DateTime::fromSecondsSince2000(0xf0000000u);
+    const double referenceToTime = test::measure(cIterations, [&fields](uint32_t) {
+        test::keep(reference::toSecondsSince2000(fields));
+    });
+    const double toTime = test::measure(cIterations, [&dateTime](uint32_t) {
+        test::keep(dateTime.toSecondsSince2000());
+    });
+    std::printf("fromSecondsSince2000: former %.1f ns, now %.1f ns\n", referenceFromTime, fromTime);
+    std::printf("toSecondsSince2000 in 2127: former %.1f ns, now %.1f ns\n", referenceToTime, toTime);
+}
+
+
+}
+
+
+int main()
+{
+    checkSecondsConversion();
+    checkDates();
+    checkAdvance();
+    benchmarkConversion();
+    return test::finish();
+}
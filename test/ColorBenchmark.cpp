@@ -0,0 +1,162 @@
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Test.hpp"
+
+#include "Color.hpp"
+#include "ColorOutput.hpp"
+#include "PixelOrder.hpp"
+#include "Random.hpp"
+
+
+/// @file
+/// Checks the SWAR mix against the scalar mix and compares their speed.
+///
+/// The mix kernels are compared without gamma correction. The output path compares
+/// the former `mix().getValue()` with `mixRaw()` and `ColorOutput::writePixel()`,
+/// which also applies the brightness and writes the bytes in wire order.
+
+
+namespace {
+
+
+const uint16_t cPixelCount = 256;
+const uint32_t cIterations = 20000;
+
+Color gColorsA[cPixelCount];
+Color gColorsB[cPixelCount];
+uint32_t gValues[cPixelCount];
+uint8_t gPixels[cPixelCount * 4];
+
+
+Color randomColor(Random &random)
+{
+    return Color(random.nextByte(), random.nextByte(), random.nextByte(), random.nextByte());
+}
+
+
+void checkMixRaw()
+{
+    Random random;
+    for (uint32_t i = 0; i < 20000; ++i) {
+        const Color a = randomColor(random);
+        const Color b = randomColor(random);
+        for (uint16_t shift = 0; shift < 0x100; ++shift) {
+            CHECK(Color::mixRaw(a.getRaw(), b.getRaw(), shift) == a.mix(b, shift).getRaw());
+        }
+    }
+    // The extreme values, where a carry into the next lane would show.
+    const Color white(0xff, 0xff, 0xff, 0xff);
+    const Color black;
+    for (uint16_t shift = 0; shift < 0x100; ++shift) {
+        CHECK(Color::mixRaw(white.getRaw(), white.getRaw(), shift) == white.getRaw());
+        CHECK(Color::mixRaw(white.getRaw(), black.getRaw(), shift) == white.mix(black, shift).getRaw());
+        CHECK(Color::mixRaw(black.getRaw(), white.getRaw(), shift) == black.mix(white, shift).getRaw());
+    }
+}
+
+
+void checkMixSpan()
+{
+    Random random;
+    for (uint16_t i = 0; i < cPixelCount; ++i) {
+        gColorsA[i] = randomColor(random);
+        gColorsB[i] = randomColor(random);
+    }
+    for (uint16_t shift = 0; shift < 0x100; ++shift) {
+        Color::mixSpan(gColorsA, gColorsB, static_cast<uint8_t>(shift), gValues, cPixelCount);
+        for (uint16_t i = 0; i < cPixelCount; ++i) {
+            CHECK(gValues[i] == gColorsA[i].mix(gColorsB[i], shift).getRaw());
+        }
+    }
+}
+
+
+void checkGetRaw()
+{
+    const Color color(0x12, 0x34, 0x56, 0x78);
+    CHECK(color.getRaw() == 0x78563412u);
+    const Color restored = Color::fromRaw(color.getRaw());
+    CHECK(restored.r == color.r && restored.g == color.g && restored.b == color.b && restored.w == color.w);
+}
+
+
+void printComparison(const char *name, double scalarTime, double swarTime)
+{
+    const bool isFaster = swarTime < scalarTime;
+    std::printf("Per pixel %s: scalar %.2f ns, SWAR %.2f ns, SWAR is %.2fx %s\n",
+        name, scalarTime / cPixelCount, swarTime / cPixelCount,
+        isFaster ? scalarTime / swarTime : swarTime / scalarTime, isFaster ? "faster" : "slower");
+}
+
+
+void benchmarkMix()
+{
+    Random random;
+    for (uint16_t i = 0; i < cPixelCount; ++i) {
+        gColorsA[i] = randomColor(random);
+        gColorsB[i] = randomColor(random);
+    }
+    // The mix kernel alone: scalar mix against the SWAR mix, both without gamma.
+    const double scalarMixTime = test::measure(cIterations, [](uint32_t iteration) {
+        const uint8_t shift = static_cast<uint8_t>(iteration);
+        for (uint16_t i = 0; i < cPixelCount; ++i) {
+            gValues[i] = gColorsA[i].mix(gColorsB[i], shift).getRaw();
+        }
+        test::keep(gValues);
+    });
+    const double swarMixTime = test::measure(cIterations, [](uint32_t iteration) {
+        const uint8_t shift = static_cast<uint8_t>(iteration);
+        Color::mixSpan(gColorsA, gColorsB, shift, gValues, cPixelCount);
+        test::keep(gValues);
+    });
+    // The complete output of one pixel: the former scalar mix with gamma correction, against
+    // the SWAR mix with the combined brightness and gamma table written in wire order.
+    const double scalarOutputTime = test::measure(cIterations, [](uint32_t iteration) {
+        const uint8_t shift = static_cast<uint8_t>(iteration);
+        for (uint16_t i = 0; i < cPixelCount; ++i) {
+            gValues[i] = gColorsA[i].mix(gColorsB[i], shift).getValue();
+        }
+        test::keep(gValues);
+    });
+    const ColorOutput output;
+    const double swarOutputTime = test::measure(cIterations, [&output](uint32_t iteration) {
+        const uint8_t shift = static_cast<uint8_t>(iteration);
+        uint8_t *pixelsOut = gPixels;
+        uint8_t difference = 0;
+        for (uint16_t i = 0; i < cPixelCount; ++i) {
+            pixelsOut = output.writePixel<PixelOrder::GRBW>(
+                Color::mixRaw(gColorsA[i].getRaw(), gColorsB[i].getRaw(), shift), pixelsOut, difference);
+        }
+        test::keep(difference);
+    });
+    printComparison("mix", scalarMixTime, swarMixTime);
+    printComparison("output", scalarOutputTime, swarOutputTime);
+}
+
+
+}
+
+
+int main()
+{
+    checkGetRaw();
+    checkMixRaw();
+    checkMixSpan();
+    benchmarkMix();
+    return test::finish();
+}
@@ -0,0 +1,148 @@
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Test.hpp"
+
+#include "DS3231.hpp"
+#include "MockDS3231Bus.hpp"
+
+
+/// @file
+/// Reports the bus costs of each call of the DS3231 driver, using the mocked chip.
+
+
+namespace {
+
+
+using lr::DateTime;
+using lr::MockDS3231Bus;
+namespace DS3231 = lr::DS3231;
+
+
+MockDS3231Bus gBus;
+
+
+/// The bus costs of one driver call.
+///
+struct Cost
+{
+    uint32_t transactions;
+    uint32_t bytes;
+    uint32_t busTime;
+};
+
+
+/// Run a driver call, print and return its bus costs.
+///
+template<typename tFunction>
+Cost measureCost(const char *name, tFunction function)
+{
+    gBus.resetCounters();
+    function();
+    const Cost cost = {gBus.getTransactionCount(), gBus.getByteCount(), gBus.getBusTime()};
+    std::printf("%-32s %3u transactions %4u bytes %6u us\n", name,
+        static_cast<unsigned>(cost.transactions), static_cast<unsigned>(cost.bytes),
+        static_cast<unsigned>(cost.busTime));
+    return cost;
+}
+
+
+void benchmarkDriver()
+{
+    std::printf("Bus costs at 100 kHz:\n");
+    DS3231::initialize(gBus);
+    gBus.registers[static_cast<uint8_t>(DS3231::Register::Status)] = 0x88;
+    // The first write loads the shadow copy.
+    const Cost setDateTime = measureCost("setDateTime (first call)", []() {
+        DS3231::setDateTime(DateTime(2020, 6, 21, 19, 30, 15));
+    });
+    CHECK(setDateTime.transactions == 4);
+    const Cost getDateTime = measureCost("getDateTime", []() {
+        test::keep(DS3231::getDateTime());
+    });
+    CHECK(getDateTime.transactions == 2);
+    CHECK(getDateTime.bytes == 2 + 1 + DS3231::cDateTimeRegisterCount);
+    measureCost("isRunning", []() {
+        test::keep(DS3231::isRunning());
+    });
+    measureCost("getTemperature", []() {
+        test::keep(DS3231::getTemperature());
+    });
+    // All alarm, control and status changes are written in one burst.
+    const Cost setAlarm = measureCost("setAlarm", []() {
+        DS3231::setAlarm(DateTime(2020, 6, 22, 6, 0, 0));
+    });
+    CHECK(setAlarm.transactions == 1);
+    // Only the status register is written, to clear the alarm flag.
+    const Cost sameAlarm = measureCost("setAlarm (same alarm)", []() {
+        DS3231::setAlarm(DateTime(2020, 6, 22, 6, 0, 0));
+    });
+    CHECK(sameAlarm.transactions == 1);
+    CHECK(sameAlarm.bytes == 3);
+    measureCost("alarmFired", []() {
+        test::keep(DS3231::alarmFired());
+    });
+    const Cost clearAlarm = measureCost("clearAlarm", []() {
+        DS3231::clearAlarm();
+    });
+    CHECK(clearAlarm.transactions == 1);
+    const Cost unchangedFlag = measureCost("writeFlag and commit (unchanged)", []() {
+        DS3231::writeFlag(DS3231::Control::INTCN, true);
+        DS3231::commit();
+    });
+    CHECK(unchangedFlag.transactions == 0);
+    const Cost agingOffset = measureCost("writeRegister masked (no shadow)", []() {
+        DS3231::writeRegister(DS3231::Register::AgingOffset, 0x05, 0x0f);
+    });
+    CHECK(agingOffset.transactions == 3);
+    uint8_t time[DS3231::cDateTimeRegisterCount];
+    lr::RegisterRequest timeRequest(lr::RegisterRequest::Type::Read,
+        static_cast<uint8_t>(DS3231::Register::Seconds), time, sizeof(time));
+    measureCost("processRequests (time read)", [&timeRequest]() {
+        DS3231::submitRequest(timeRequest);
+        DS3231::processRequests();
+    });
+    const Cost snapshot = measureCost("readSnapshot", []() {
+        DS3231::RegisterSnapshot snapshot;
+        CHECK(DS3231::readSnapshot(snapshot));
+        test::keep(snapshot);
+    });
+    CHECK(snapshot.transactions == 2);
+}
+
+
+void checkMockBounds()
+{
+    uint8_t data[2] = {0x12, 0x34};
+    CHECK(!gBus.readRegisters(MockDS3231Bus::cChipAddress, MockDS3231Bus::cRegisterCount, data, 1));
+    CHECK(!gBus.writeRegisters(MockDS3231Bus::cChipAddress, 0xff, data, 2));
+    CHECK(!gBus.readRegisters(0x57, 0, data, 1));
+    // Reads wrap around to the first register, like the chip.
+    CHECK(gBus.readRegisters(MockDS3231Bus::cChipAddress, MockDS3231Bus::cRegisterCount - 1, data, 2));
+    CHECK(data[1] == gBus.registers[0]);
+}
+
+
+}
+
+
+int main()
+{
+    benchmarkDriver();
+    checkMockBounds();
+    return test::finish();
+}
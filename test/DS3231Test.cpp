@@ -0,0 +1,233 @@
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Test.hpp"
+
+#include "DS3231.hpp"
+#include "MockDS3231Bus.hpp"
+
+#include <cstring>
+
+
+/// @file
+/// Checks the register writes of the DS3231 driver with a mocked chip.
+
+
+namespace {
+
+
+using lr::DateTime;
+using lr::MockDS3231Bus;
+namespace DS3231 = lr::DS3231;
+
+
+/// A mocked chip where the transfers can fail.
+///
+class FailingBus : public MockDS3231Bus
+{
+public:
+    FailingBus()
+        : isReadFailing(false), isWriteFailing(false) {
+    }
+
+    bool writeRegisters(uint8_t address, uint8_t firstRegister, const uint8_t *data, uint8_t count) override {
+        if (isWriteFailing) {
+            return false;
+        }
+        return MockDS3231Bus::writeRegisters(address, firstRegister, data, count);
+    }
+
+    bool readRegisters(uint8_t address, uint8_t firstRegister, uint8_t *data, uint8_t count) override {
+        if (isReadFailing) {
+            return false;
+        }
+        return MockDS3231Bus::readRegisters(address, firstRegister, data, count);
+    }
+
+public:
+    bool isReadFailing; ///< If all reads fail.
+    bool isWriteFailing; ///< If all writes fail.
+};
+
+
+const uint8_t cControl = static_cast<uint8_t>(DS3231::Register::Control);
+const uint8_t cStatus = static_cast<uint8_t>(DS3231::Register::Status);
+const uint8_t cAlarm1Seconds = static_cast<uint8_t>(DS3231::Register::Alarm1Seconds);
+const uint8_t cInterruptFlags = static_cast<uint8_t>(DS3231::Control::INTCN) | static_cast<uint8_t>(DS3231::Control::A1IE);
+
+
+void checkWrites()
+{
+    FailingBus bus;
+    DS3231::initialize(bus);
+    CHECK(DS3231::setDateTime(DateTime(2020, 6, 21, 19, 30, 15)));
+    CHECK(DS3231::getDateTime() == DateTime(2020, 6, 21, 19, 30, 15));
+    CHECK(!DS3231::setDateTime(DateTime(2200, 1, 1)));
+    CHECK(DS3231::setAlarm(DateTime(2020, 6, 21, 20, 0, 0)));
+    CHECK(bus.registers[cAlarm1Seconds] == 0x00);
+    CHECK(bus.registers[cAlarm1Seconds + 1] == 0x00);
+    CHECK(bus.registers[cAlarm1Seconds + 2] == 0x20);
+    CHECK(bus.registers[cAlarm1Seconds + 3] == 0x21);
+    CHECK((bus.registers[cControl] & cInterruptFlags) == cInterruptFlags);
+    // Without changes, commit does not use the bus.
+    bus.resetCounters();
+    CHECK(DS3231::commit());
+    CHECK(bus.getTransactionCount() == 0);
+}
+
+
+/// The expected alarm registers for 2020-06-21 (Sunday) 20:15:30, in every mode.
+///
+struct AlarmEncoding {
+    DS3231::AlarmMode mode;
+    uint8_t registers[4];
+};
+
+const AlarmEncoding cAlarmEncodings[] = {
+    {DS3231::AlarmMode::EverySecond, {0xb0, 0x95, 0xa0, 0xa1}},
+    {DS3231::AlarmMode::Second, {0x30, 0x95, 0xa0, 0xa1}},
+    {DS3231::AlarmMode::MinuteSecond, {0x30, 0x15, 0xa0, 0xa1}},
+    {DS3231::AlarmMode::HourMinuteSecond, {0x30, 0x15, 0x20, 0xa1}},
+    {DS3231::AlarmMode::DateHourMinuteSecond, {0x30, 0x15, 0x20, 0x21}},
+    {DS3231::AlarmMode::DayOfWeekHourMinuteSecond, {0x30, 0x15, 0x20, 0x47}},
+};
+
+
+void checkAlarmModes()
+{
+    FailingBus bus;
+    DS3231::initialize(bus);
+    for (const AlarmEncoding &encoding : cAlarmEncodings) {
+        CHECK(DS3231::setAlarm(DateTime(2020, 6, 21, 20, 15, 30), encoding.mode));
+        CHECK(std::memcmp(bus.registers + cAlarm1Seconds, encoding.registers, 4) == 0);
+        CHECK((bus.registers[cControl] & cInterruptFlags) == cInterruptFlags);
+    }
+}
+
+
+void checkAlarmFlag()
+{
+    const uint8_t alarmFlag = static_cast<uint8_t>(DS3231::Status::A1F);
+    FailingBus bus;
+    DS3231::initialize(bus);
+    CHECK(!DS3231::alarmFired());
+    // Setting the alarm clears a previous one.
+    bus.registers[cStatus] |= alarmFlag;
+    CHECK(DS3231::alarmFired());
+    CHECK(DS3231::setAlarm(DateTime(2020, 6, 21, 20, 0, 0)));
+    CHECK(!DS3231::alarmFired());
+    // The chip sets the flag when the alarm triggers.
+    bus.registers[cStatus] |= alarmFlag;
+    CHECK(DS3231::alarmFired());
+    CHECK(DS3231::clearAlarm());
+    CHECK(!DS3231::alarmFired());
+    CHECK((bus.registers[cStatus] & alarmFlag) == 0);
+    CHECK((bus.registers[cControl] & static_cast<uint8_t>(DS3231::Control::A1IE)) == 0);
+    // The other flags are kept.
+    CHECK((bus.registers[cControl] & static_cast<uint8_t>(DS3231::Control::INTCN)) != 0);
+}
+
+
+void checkFailedWrites()
+{
+    FailingBus bus;
+    DS3231::initialize(bus);
+    CHECK(DS3231::setDateTime(DateTime(2020, 6, 21, 19, 30, 15)));
+    // A failed write keeps the changes in the shadow copy.
+    bus.isWriteFailing = true;
+    CHECK(!DS3231::setAlarm(DateTime(2020, 6, 21, 20, 15, 0)));
+    CHECK(bus.registers[cAlarm1Seconds + 1] == 0x00);
+    CHECK((bus.registers[cControl] & cInterruptFlags) == 0);
+    CHECK(!DS3231::readFlag(DS3231::Control::A1IE)); // Reads the chip, not the shadow copy.
+    CHECK(!DS3231::commit());
+    CHECK(!DS3231::setDateTime(DateTime(2020, 6, 21, 19, 30, 15)));
+    // The next commit writes them.
+    bus.isWriteFailing = false;
+    CHECK(DS3231::commit());
+    CHECK(bus.registers[cAlarm1Seconds + 1] == 0x15);
+    CHECK(bus.registers[cAlarm1Seconds + 2] == 0x20);
+    CHECK((bus.registers[cControl] & cInterruptFlags) == cInterruptFlags);
+    CHECK(DS3231::readFlag(DS3231::Control::A1IE));
+    bus.resetCounters();
+    CHECK(DS3231::commit());
+    CHECK(bus.getTransactionCount() == 0);
+    // A cleared flag stays cleared until it is written.
+    bus.registers[cStatus] |= static_cast<uint8_t>(DS3231::Status::A1F);
+    bus.isWriteFailing = true;
+    CHECK(!DS3231::clearAlarm());
+    CHECK((bus.registers[cStatus] & static_cast<uint8_t>(DS3231::Status::A1F)) != 0);
+    bus.isWriteFailing = false;
+    CHECK(DS3231::commit());
+    CHECK((bus.registers[cStatus] & static_cast<uint8_t>(DS3231::Status::A1F)) == 0);
+    CHECK((bus.registers[cControl] & static_cast<uint8_t>(DS3231::Control::A1IE)) == 0);
+}
+
+
+void checkFailedReads()
+{
+    FailingBus bus;
+    bus.registers[cControl] = static_cast<uint8_t>(DS3231::Control::INTCN);
+    DS3231::initialize(bus);
+    // The shadow copy can not be loaded, nothing is changed.
+    bus.isReadFailing = true;
+    CHECK(!DS3231::setFlag(DS3231::Control::A1IE));
+    CHECK(!DS3231::writeRegister(DS3231::Register::AgingOffset, 0x12, 0x0f));
+    CHECK(DS3231::commit());
+    CHECK(bus.registers[cControl] == static_cast<uint8_t>(DS3231::Control::INTCN));
+    uint8_t values[DS3231::cDateTimeRegisterCount];
+    CHECK(!DS3231::readRegister(DS3231::Register::Seconds, values, sizeof(values)));
+    // After the bus recovers, the shadow copy is loaded.
+    bus.isReadFailing = false;
+    CHECK(DS3231::setFlag(DS3231::Control::A1IE));
+    CHECK(DS3231::commit());
+    CHECK(bus.registers[cControl] == cInterruptFlags);
+}
+
+
+void checkDeadBus()
+{
+    const uint8_t stopFlag = static_cast<uint8_t>(DS3231::Status::OSF);
+    FailingBus bus;
+    DS3231::initialize(bus);
+    CHECK(DS3231::isRunning());
+    bus.registers[cStatus] |= stopFlag;
+    CHECK(!DS3231::isRunning());
+    bus.registers[cStatus] &= ~stopFlag;
+    // A chip which does not respond is not running, and reads like an idle bus.
+    bus.isReadFailing = true;
+    CHECK(!DS3231::isRunning());
+    CHECK(DS3231::readRegister(DS3231::Register::Status) == 0xff);
+    CHECK(DS3231::readFlag(DS3231::Status::OSF));
+    bus.isReadFailing = false;
+    CHECK(DS3231::isRunning());
+    CHECK(DS3231::readRegister(DS3231::Register::Status) == 0x00);
+}
+
+
+}
+
+
+int main()
+{
+    checkWrites();
+    checkAlarmModes();
+    checkAlarmFlag();
+    checkFailedWrites();
+    checkFailedReads();
+    checkDeadBus();
+    return test::finish();
+}
@@ -0,0 +1,286 @@
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Test.hpp"
+
+#include "DateTime.hpp"
+#include "Random.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+
+/// @file
+/// Fuzzes the date/time parser with valid and invalid text and measures its throughput.
+
+
+namespace {
+
+
+using lr::DateTime;
+typedef DateTime::Format Format;
+typedef DateTime::ParseResult ParseResult;
+
+const Format cFormats[] = {
+    Format::ISO, Format::Long, Format::ISODate, Format::ISOBasicDate,
+    Format::ISOTime, Format::ISOBasicTime, Format::ShortDate, Format::ShortTime};
+
+const char * const cLayouts[] = {
+    "yyyy-MM-ddThh:mm:ss", "yyyy-MM-dd hh:mm:ss", "yyyy-MM-dd", "yyyyMMdd",
+    "hh:mm:ss", "hhmmss", "dd.MM.", "hh:mm"};
+
+/// Characters which are likely to confuse a parser.
+const char cFuzzCharacters[] = "0123456789-: T.+/\tx\x7f\xff";
+
+
+/// The fields of a date/time.
+///
+struct Fields
+{
+    unsigned long year;
+    unsigned long month;
+    unsigned long day;
+    unsigned long hour;
+    unsigned long minute;
+    unsigned long second;
+};
+
+
+Fields getFields(const DateTime &dateTime)
+{
+    const Fields fields = {dateTime.getYear(), dateTime.getMonth(), dateTime.getDay(),
+        dateTime.getHour(), dateTime.getMinute(), dateTime.getSecond()};
+    return fields;
+}
+
+
+bool isEqual(const Fields &a, const Fields &b)
+{
+    return a.year == b.year && a.month == b.month && a.day == b.day
+        && a.hour == b.hour && a.minute == b.minute && a.second == b.second;
+}
+
+
+bool isLeapYear(unsigned long year)
+{
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+
+unsigned long getDaysInMonth(unsigned long year, unsigned long month)
+{
+    static const uint8_t cDays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return (month == 2 && isLeapYear(year)) ? 29 : cDays[month - 1];
+}
+
+
+/// An independent, straightforward parser to get the expected result.
+///
+ParseResult parseReference(const char *text, size_t length, Format format, Fields &fields)
+{
+    const char *layout = cLayouts[static_cast<uint8_t>(format)];
+    if (length != std::strlen(layout)) {
+        return ParseResult::WrongLength;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        const bool isField = std::strchr("yMdhms", layout[i]) != nullptr;
+        if (isField ? (text[i] < '0' || text[i] > '9') : (text[i] != layout[i])) {
+            return ParseResult::InvalidCharacter;
+        }
+    }
+    const struct { char letter; unsigned long *value; } cFields[] = {
+        {'y', &fields.year}, {'M', &fields.month}, {'d', &fields.day},
+        {'h', &fields.hour}, {'m', &fields.minute}, {'s', &fields.second}};
+    for (const auto &field : cFields) {
+        const char *begin = std::strchr(layout, field.letter);
+        if (begin != nullptr) {
+            const size_t offset = static_cast<size_t>(begin - layout);
+            const size_t digits = std::strspn(begin, std::string(1, field.letter).c_str());
+            *field.value = std::strtoul(std::string(text + offset, digits).c_str(), nullptr, 10);
+        }
+    }
+    if (fields.year < 2000 || fields.year > 9999 || fields.month < 1 || fields.month > 12
+        || fields.day < 1 || fields.day > getDaysInMonth(fields.year, fields.month)
+        || fields.hour > 23 || fields.minute > 59 || fields.second > 59) {
+        return ParseResult::OutOfRange;
+    }
+    return ParseResult::Success;
+}
+
+
+/// Parse the text and compare everything with the reference.
+///
+void checkParse(const char *text, size_t length, Format format, const DateTime &start)
+{
+    Fields expected = getFields(start);
+    const ParseResult expectedResult = parseReference(text, length, format, expected);
+    DateTime dateTime = start;
+    const ParseResult result = dateTime.parse(text, length, format);
+    CHECK(result == expectedResult);
+    if (result == ParseResult::Success) {
+        CHECK(isEqual(getFields(dateTime), expected));
+        CHECK(dateTime == DateTime(dateTime.getYear(), dateTime.getMonth(), dateTime.getDay(),
+            dateTime.getHour(), dateTime.getMinute(), dateTime.getSecond()));
+        CHECK(dateTime.getDayOfWeek() == DateTime(dateTime.getYear(), dateTime.getMonth(), dateTime.getDay()).getDayOfWeek());
+        // Writing the result again gives the same text.
+        char out[DateTime::getStringLength(Format::ISO) + 1];
+        CHECK(dateTime.toChars(out, sizeof(out), format) == length);
+        CHECK(std::memcmp(out, text, length) == 0);
+    } else {
+        CHECK(isEqual(getFields(dateTime), getFields(start)));
+    }
+}
+
+
+DateTime randomDateTime(Random &random)
+{
+    const uint32_t seconds = (static_cast<uint32_t>(random.nextByte()) << 24)
+        | (static_cast<uint32_t>(random.nextByte()) << 16)
+        | (static_cast<uint32_t>(random.nextByte()) << 8)
+        | random.nextByte();
+    if ((seconds & 0x7) == 0) {
+        // Also cover the years up to 9999.
+        return DateTime(2000 + (seconds >> 8) % 8000, 1 + (seconds >> 3) % 12, 1 + (seconds >> 7) % 31,
+            (seconds >> 12) % 24, (seconds >> 17) % 60, (seconds >> 23) % 60);
+    }
+    return DateTime::fromSecondsSince2000(seconds);
+}
+
+
+/// Valid text of every format, written and parsed again.
+///
+void checkRoundTrip(Random &random)
+{
+    for (uint32_t i = 0; i < 200000; ++i) {
+        const DateTime source = randomDateTime(random);
+        const DateTime start = randomDateTime(random);
+        for (Format format : cFormats) {
+            char text[DateTime::getStringLength(Format::ISO) + 1];
+            const size_t length = source.toChars(text, sizeof(text), format);
+            CHECK(length == DateTime::getStringLength(format));
+            checkParse(text, length, format, start);
+            // Only February 29th can fail, if it is combined with the year of a short date.
+            const bool isLeapDay = source.getMonth() == 2 && source.getDay() == 29;
+            if (format != Format::ShortDate || !isLeapDay || isLeapYear(start.getYear())) {
+                DateTime dateTime = start;
+                CHECK(dateTime.parse(text, length, format) == ParseResult::Success);
+            }
+        }
+    }
+}
+
+
+/// Valid text with random mutations, and random text.
+///
+void checkInvalidText(Random &random)
+{
+    for (uint32_t i = 0; i < 500000; ++i) {
+        const DateTime source = randomDateTime(random);
+        const DateTime start = randomDateTime(random);
+        const Format format = cFormats[random.nextByte() % 8];
+        char text[DateTime::getStringLength(Format::ISO) + 2] = {};
+        size_t length = source.toChars(text, sizeof(text), format);
+        const uint8_t mutation = random.nextByte() % 8;
+        if (mutation == 0) {
+            // Random text with the correct length.
+            for (size_t j = 0; j < length; ++j) {
+                text[j] = cFuzzCharacters[random.nextByte() % (sizeof(cFuzzCharacters) - 1)];
+            }
+        } else if (mutation == 1) {
+            // A wrong length.
+            length = random.nextByte() % sizeof(text);
+        } else if (mutation == 2) {
+            // Any byte at a random position.
+            text[random.nextByte() % length] = static_cast<char>(random.nextByte());
+        } else {
+            // Digits and separators at random positions, mostly out of range values.
+            const uint8_t count = 1 + (mutation % 3);
+            for (uint8_t j = 0; j < count; ++j) {
+                text[random.nextByte() % length] = cFuzzCharacters[random.nextByte() % 12];
+            }
+        }
+        checkParse(text, length, format, start);
+    }
+}
+
+
+/// Selected edge cases.
+///
+void checkEdgeCases()
+{
+    const DateTime start(2019, 12, 24, 18, 30, 15);
+    const char * const cTexts[] = {
+        "2000-01-01T00:00:00", "9999-12-31T23:59:59", "1999-12-31T23:59:59", "2019-02-29T00:00:00",
+        "2020-02-29T00:00:00", "2100-02-29T00:00:00", "2400-02-29T00:00:00", "2019-00-10T00:00:00",
+        "2019-13-10T00:00:00", "2019-04-31T00:00:00", "2019-04-30T24:00:00", "2019-04-30T23:60:00",
+        "2019-04-30T23:59:60", "2019-04-30 23:59:59", "2019-04-30T23:59:5", "2019-04-30T23:59:5a",
+        "2019-04-30T23:59:5/", "2019-04-30T23:59:5:", " 2019-04-30T23:59:5", "+019-04-30T23:59:59"};
+    for (const char *text : cTexts) {
+        checkParse(text, std::strlen(text), Format::ISO, start);
+    }
+    checkParse("29.02.", 6, Format::ShortDate, start);
+    checkParse("29.02.", 6, Format::ShortDate, DateTime(2020, 1, 1));
+    checkParse("24:00", 5, Format::ShortTime, start);
+    checkParse("", 0, Format::ShortTime, start);
+}
+
+
+int sscanfParse(const char *text, DateTime &dateTime)
+{
+    unsigned year, month, day, hour, minute, second;
+    const int count = std::sscanf(text, "%4u-%2u-%2uT%2u:%2u:%2u", &year, &month, &day, &hour, &minute, &second);
+    if (count == 6) {
+        dateTime = DateTime(year, month, day, hour, minute, second);
+    }
+    return count;
+}
+
+
+void benchmarkParse(Random &random)
+{
+    const uint16_t cTextCount = 1024;
+    static char texts[cTextCount][DateTime::getStringLength(Format::ISO) + 1];
+    for (uint16_t i = 0; i < cTextCount; ++i) {
+        randomDateTime(random).toChars(texts[i], sizeof(texts[i]), Format::ISO);
+    }
+    const uint32_t cIterations = 1000000;
+    DateTime dateTime;
+    const double parseTime = test::measure(cIterations, [&dateTime](uint32_t i) {
+        test::keep(dateTime.parse(texts[i % cTextCount], DateTime::getStringLength(Format::ISO), Format::ISO));
+        test::keep(dateTime);
+    });
+    const double sscanfTime = test::measure(cIterations, [&dateTime](uint32_t i) {
+        test::keep(sscanfParse(texts[i % cTextCount], dateTime));
+        test::keep(dateTime);
+    });
+    std::printf("Parse ISO: %.1f ns (%.1f MB/s), sscanf for comparison: %.1f ns\n",
+        parseTime, DateTime::getStringLength(Format::ISO) * 1000.0 / parseTime, sscanfTime);
+}
+
+
+}
+
+
+int main()
+{
+    Random random;
+    checkEdgeCases();
+    checkRoundTrip(random);
+    checkInvalidText(random);
+    benchmarkParse(random);
+    return test::finish();
+}
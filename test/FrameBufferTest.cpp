@@ -0,0 +1,125 @@
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Test.hpp"
+
+#include "Color.hpp"
+#include "ColorOutput.hpp"
+#include "FrameBuffer.hpp"
+#include "PaletteFrameBuffer.hpp"
+#include "PixelOrder.hpp"
+#include "Random.hpp"
+
+#include <cstring>
+
+
+/// @file
+/// Checks both frame buffers against a scalar reference and compares their speed.
+
+
+namespace {
+
+
+const uint16_t cPixelCount = 400;
+const uint32_t cIterations = 5000;
+
+FrameBuffer<cPixelCount> gFrameBuffer;
+PaletteFrameBuffer<cPixelCount> gPaletteFrameBuffer;
+Color gBaseColors[cPixelCount];
+uint8_t gPositions[cPixelCount];
+uint8_t gPixels[cPixelCount * 4];
+uint8_t gExpected[cPixelCount * 4];
+
+
+/// Render the expected pixels with the scalar color methods.
+///
+void renderExpected(const Color &begin, const Color &end, uint8_t shift, uint8_t level)
+{
+    for (uint16_t i = 0; i < cPixelCount; ++i) {
+        const Color target = begin.mix(end, gPositions[i]);
+        const Color pixel = gBaseColors[i].mix(target, shift);
+        // Wire order GRBW, with the scaling of ColorOutput.
+        const uint16_t level16 = static_cast<uint16_t>(level) + 1;
+        gExpected[i*4+0] = Color::cGamma[(pixel.g * level16) / 0x100];
+        gExpected[i*4+1] = Color::cGamma[(pixel.r * level16) / 0x100];
+        gExpected[i*4+2] = Color::cGamma[(pixel.b * level16) / 0x100];
+        gExpected[i*4+3] = Color::cGamma[(pixel.w * level16) / 0x100];
+    }
+}
+
+
+template<typename tFrameBuffer>
+void checkBlend(tFrameBuffer &frameBuffer)
+{
+    Random random;
+    ColorOutput output;
+    const Color begin(0x10, 0x80, 0xf0, 0x20);
+    const Color end(0xff, 0x20, 0x00, 0x90);
+    frameBuffer.setGradient(begin, end);
+    frameBuffer.clearBase();
+    for (uint16_t i = 0; i < cPixelCount; ++i) {
+        gBaseColors[i] = Color();
+    }
+    for (uint8_t blend = 0; blend < 4; ++blend) {
+        random.fill(gPositions, cPixelCount);
+        for (uint16_t i = 0; i < cPixelCount; ++i) {
+            frameBuffer.setTargetPosition(i, gPositions[i]);
+        }
+        for (uint16_t shift = 0; shift < 0x100; shift += 15) {
+            const uint8_t level = static_cast<uint8_t>(0xff - shift);
+            output.setBrightness(level);
+            renderExpected(begin, end, static_cast<uint8_t>(shift), level);
+            frameBuffer.template render<PixelOrder::GRBW>(output, static_cast<uint8_t>(shift), gPixels);
+            CHECK(std::memcmp(gPixels, gExpected, sizeof(gPixels)) == 0);
+        }
+        // Only a changed frame is reported as changed.
+        output.setBrightness(0xff);
+        CHECK(frameBuffer.template render<PixelOrder::GRBW>(output, 0x80, gPixels));
+        CHECK(!frameBuffer.template render<PixelOrder::GRBW>(output, 0x80, gPixels));
+        frameBuffer.commitTarget();
+        for (uint16_t i = 0; i < cPixelCount; ++i) {
+            gBaseColors[i] = begin.mix(end, gPositions[i]);
+        }
+    }
+}
+
+
+template<typename tFrameBuffer>
+double benchmarkRender(tFrameBuffer &frameBuffer)
+{
+    const ColorOutput output;
+    return test::measure(cIterations, [&frameBuffer, &output](uint32_t iteration) {
+        test::keep(frameBuffer.template render<PixelOrder::GRBW>(output, static_cast<uint8_t>(iteration), gPixels));
+    }) / cPixelCount;
+}
+
+
+}
+
+
+int main()
+{
+    checkBlend(gFrameBuffer);
+    checkBlend(gPaletteFrameBuffer);
+    std::printf("Memory for %u pixels: FrameBuffer %u bytes, PaletteFrameBuffer %u bytes\n",
+        static_cast<unsigned>(cPixelCount),
+        static_cast<unsigned>(sizeof(gFrameBuffer)),
+        static_cast<unsigned>(sizeof(gPaletteFrameBuffer)));
+    std::printf("Render per pixel: FrameBuffer %.2f ns, PaletteFrameBuffer %.2f ns\n",
+        benchmarkRender(gFrameBuffer), benchmarkRender(gPaletteFrameBuffer));
+    return test::finish();
+}
@@ -0,0 +1,132 @@
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Test.hpp"
+
+#include "FrameScheduler.hpp"
+
+
+/// @file
+/// Checks the frame scheduler with a mocked clock.
+
+
+namespace {
+
+
+/// A clock which advances a fixed step for each interrupt.
+///
+struct MockClock
+{
+    static uint32_t getTime() {
+        return time;
+    }
+
+    static void waitForInterrupt() {
+        time += tickPeriod;
+        ++interruptCount;
+    }
+
+    static uint32_t time; ///< The current time in microseconds.
+    static uint32_t tickPeriod; ///< The time between two interrupts.
+    static uint32_t interruptCount; ///< The number of waits.
+};
+
+uint32_t MockClock::time = 0;
+uint32_t MockClock::tickPeriod = 1000;
+uint32_t MockClock::interruptCount = 0;
+
+
+void checkFixedStep()
+{
+    MockClock::time = 12345;
+    MockClock::tickPeriod = 1000;
+    FrameScheduler<MockClock> scheduler(50000);
+    scheduler.start();
+    const uint32_t firstFrame = MockClock::time;
+    for (uint32_t frame = 1; frame <= 100; ++frame) {
+        // A varying amount of work, always shorter than the period.
+        const uint32_t work = (frame * 7919u) % 40000u;
+        MockClock::time += work;
+        // The busy time counts from the scheduled start, not from the wake up.
+        const uint32_t busyTime = MockClock::time - (firstFrame + (frame - 1) * 50000u);
+        CHECK(scheduler.waitForNextFrame() == 50000);
+        CHECK(scheduler.getBusyTime() == busyTime);
+        CHECK(scheduler.getLoad() == (busyTime * 0x100u) / 50000u);
+        // The frame starts with the first interrupt after the frame time, no drift.
+        CHECK(MockClock::time >= firstFrame + frame * 50000u);
+        CHECK(MockClock::time < firstFrame + frame * 50000u + 1000u);
+    }
+}
+
+
+void checkOverrun()
+{
+    MockClock::time = 0;
+    FrameScheduler<MockClock> scheduler(10000);
+    scheduler.start();
+    MockClock::interruptCount = 0;
+    MockClock::time += 25000;
+    CHECK(scheduler.waitForNextFrame() == 25000);
+    CHECK(MockClock::interruptCount == 0);
+    CHECK(scheduler.getLoad() == 0xff);
+    // The schedule restarts at the time of the overrun.
+    MockClock::time += 2000;
+    CHECK(scheduler.waitForNextFrame() == 10000);
+    CHECK(MockClock::time == 35000);
+    CHECK(scheduler.getLoad() == (2000u * 0x100u) / 10000u);
+}
+
+
+void checkTimerWrap()
+{
+    MockClock::time = 0xffffffffu - 30000u;
+    MockClock::tickPeriod = 1000;
+    FrameScheduler<MockClock> scheduler(50000);
+    scheduler.start();
+    const uint32_t firstFrame = MockClock::time;
+    MockClock::time += 1000;
+    CHECK(scheduler.waitForNextFrame() == 50000);
+    CHECK(scheduler.getBusyTime() == 1000);
+    CHECK(static_cast<uint32_t>(MockClock::time - firstFrame) >= 50000u);
+    CHECK(static_cast<uint32_t>(MockClock::time - firstFrame) < 51000u);
+}
+
+
+void checkFramePeriodChange()
+{
+    MockClock::time = 0;
+    MockClock::tickPeriod = 1000;
+    FrameScheduler<MockClock> scheduler(50000);
+    scheduler.start();
+    scheduler.setFramePeriod(1000000);
+    CHECK(scheduler.getFramePeriod() == 1000000);
+    CHECK(scheduler.waitForNextFrame() == 1000000);
+    CHECK(MockClock::time == 1000000);
+}
+
+
+}
+
+
+int main()
+{
+    checkFixedStep();
+    checkOverrun();
+    checkTimerWrap();
+    checkFramePeriodChange();
+    return test::finish();
+}
@@ -0,0 +1,171 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include "I2cBus.hpp"
+
+#include <cstdint>
+
+
+namespace lr {
+
+
+/// A mocked DS3231 chip on a simulated I2C bus, to use the driver on the host.
+///
+/// The mock keeps the 19 registers of the chip and implements the register
+/// pointer with auto increment, the alarm and oscillator stop flags which can
+/// only be cleared, and the read only bits of the status register. The time
+/// does not run, a test sets the registers directly. A transfer to another
+/// address or starting at a register which does not exist fails.
+///
+/// Every transaction is counted with the transferred bytes, including the
+/// address and register bytes, and the time it would take on the real bus.
+/// This shows the bus costs of each driver call.
+///
+class MockDS3231Bus : public I2cBus
+{
+public:
+    /// The address of the chip.
+    ///
+    static constexpr uint8_t cChipAddress = 0x68;
+
+    /// The number of registers in the chip.
+    ///
+    static constexpr uint8_t cRegisterCount = 0x13;
+
+public:
+    /// Create a new mock with all registers at zero.
+    ///
+    /// @param busFrequency The clock frequency of the simulated bus in Hz.
+    ///
+    explicit MockDS3231Bus(uint32_t busFrequency = 100000)
+        : registers(), _busFrequency(busFrequency), _transactionCount(0), _byteCount(0), _busBits(0) {
+    }
+
+public: // Implement I2cBus
+    bool writeRegisters(uint8_t address, uint8_t firstRegister, const uint8_t *data, uint8_t count) override {
+        if (address != cChipAddress) {
+            addTransaction(1);
+            return false;
+        }
+        if (firstRegister >= cRegisterCount) {
+            addTransaction(2);
+            return false;
+        }
+        // Address, register and the values.
+        addTransaction(2 + count);
+        uint8_t reg = firstRegister;
+        for (uint8_t i = 0; i < count; ++i) {
+            writeRegister(reg, data[i]);
+            reg = nextRegister(reg);
+        }
+        return true;
+    }
+
+    bool readRegisters(uint8_t address, uint8_t firstRegister, uint8_t *data, uint8_t count) override {
+        if (address != cChipAddress) {
+            addTransaction(1);
+            return false;
+        }
+        if (firstRegister >= cRegisterCount) {
+            addTransaction(2);
+            return false;
+        }
+        // Address and register, then address and the values.
+        addTransaction(2);
+        addTransaction(1 + count);
+        uint8_t reg = firstRegister;
+        for (uint8_t i = 0; i < count; ++i) {
+            data[i] = registers[reg];
+            reg = nextRegister(reg);
+        }
+        return true;
+    }
+
+public:
+    /// Reset all counters.
+    ///
+    inline void resetCounters() {
+        _transactionCount = 0;
+        _byteCount = 0;
+        _busBits = 0;
+    }
+
+    /// Get the number of transactions, from start to stop condition.
+    ///
+    inline uint32_t getTransactionCount() const {
+        return _transactionCount;
+    }
+
+    /// Get the number of bytes on the bus, including the address bytes.
+    ///
+    inline uint32_t getByteCount() const {
+        return _byteCount;
+    }
+
+    /// Get the simulated bus time in microseconds.
+    ///
+    /// Each byte needs nine clocks with the acknowledge bit, plus one clock
+    /// each for the start and stop condition of a transaction.
+    ///
+    inline uint32_t getBusTime() const {
+        return static_cast<uint32_t>((static_cast<uint64_t>(_busBits) * 1000000u) / _busFrequency);
+    }
+
+public:
+    uint8_t registers[cRegisterCount]; ///< The registers of the chip.
+
+private:
+    /// Count a transaction with the given number of bytes.
+    ///
+    inline void addTransaction(uint32_t bytes) {
+        ++_transactionCount;
+        _byteCount += bytes;
+        _busBits += bytes * 9 + 2;
+    }
+
+    /// Get the register after the given one, the chip wraps around to the first one.
+    ///
+    static inline uint8_t nextRegister(uint8_t reg) {
+        return (reg + 1 < cRegisterCount) ? reg + 1 : 0;
+    }
+
+    /// Write a register like the chip.
+    ///
+    inline void writeRegister(uint8_t reg, uint8_t value) {
+        if (reg == 0x0f) {
+            // A1F, A2F and OSF can only be cleared, BSY is read only.
+            const uint8_t clearOnly = 0x83;
+            registers[reg] = (registers[reg] & ((value & clearOnly) | 0x04)) | (value & 0x08);
+        } else if (reg < 0x11) {
+            registers[reg] = value; // The temperature registers are read only.
+        }
+    }
+
+private:
+    uint32_t _busFrequency; ///< The simulated bus frequency in Hz.
+    uint32_t _transactionCount; ///< The number of transactions.
+    uint32_t _byteCount; ///< The number of bytes.
+    uint32_t _busBits; ///< The number of bit clocks on the bus.
+};
+
+
+}
+
+
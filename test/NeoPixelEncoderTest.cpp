@@ -0,0 +1,159 @@
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Test.hpp"
+
+#include "NeoPixelEncoder.hpp"
+#include "Random.hpp"
+
+#include <cstring>
+
+
+/// @file
+/// Checks the SPI encoding of the NeoPixel waveform and measures its speed.
+
+
+namespace {
+
+
+using NeoPixelEncoder::Encoding;
+
+const size_t cByteCount = 24 * 4;
+
+uint8_t gPixels[cByteCount];
+uint8_t gEncoded[NeoPixelEncoder::getEncodedSize(Encoding::FourBit, cByteCount)];
+uint8_t gExpected[NeoPixelEncoder::getEncodedSize(Encoding::FourBit, cByteCount)];
+
+
+/// Encode bit by bit, the way the protocol is specified.
+///
+size_t encodeReference(Encoding encoding, const uint8_t *pixels, size_t byteCount, uint8_t *out)
+{
+    const uint8_t bitsPerBit = static_cast<uint8_t>(encoding);
+    const size_t size = NeoPixelEncoder::getEncodedSize(encoding, byteCount);
+    std::memset(out, 0, size);
+    size_t spiBit = 0;
+    for (size_t i = 0; i < byteCount; ++i) {
+        for (int8_t bit = 7; bit >= 0; --bit) {
+            const uint8_t highBits = ((pixels[i] >> bit) & 1) != 0 ? 2 : 1;
+            for (uint8_t j = 0; j < highBits; ++j) {
+                out[(spiBit + j) / 8] |= static_cast<uint8_t>(0x80u >> ((spiBit + j) % 8));
+            }
+            spiBit += bitsPerBit;
+        }
+    }
+    return size;
+}
+
+
+/// Decode the waveform by the length of the high pulses.
+///
+bool decode(Encoding encoding, const uint8_t *in, size_t byteCount, uint8_t *pixelsOut)
+{
+    const uint8_t bitsPerBit = static_cast<uint8_t>(encoding);
+    size_t spiBit = 0;
+    for (size_t i = 0; i < byteCount; ++i) {
+        uint8_t value = 0;
+        for (uint8_t bit = 0; bit < 8; ++bit) {
+            uint8_t highBits = 0;
+            for (uint8_t j = 0; j < bitsPerBit; ++j, ++spiBit) {
+                const bool isHigh = (in[spiBit / 8] & (0x80u >> (spiBit % 8))) != 0;
+                if (isHigh && highBits != j) {
+                    return false; // A high level after a low level.
+                }
+                highBits += (isHigh ? 1 : 0);
+            }
+            if (highBits != 1 && highBits != 2) {
+                return false;
+            }
+            value = static_cast<uint8_t>((value << 1) | (highBits - 1));
+        }
+        pixelsOut[i] = value;
+    }
+    return true;
+}
+
+
+void checkEncoding(Encoding encoding)
+{
+    const size_t size = NeoPixelEncoder::getEncodedSize(encoding, cByteCount);
+    // Every byte value at every position in a 32 bit word.
+    for (uint16_t value = 0; value < 0x100; ++value) {
+        for (size_t i = 0; i < cByteCount; ++i) {
+            gPixels[i] = static_cast<uint8_t>(value + i);
+        }
+        CHECK(NeoPixelEncoder::encode(encoding, gPixels, cByteCount, gEncoded) == size);
+        encodeReference(encoding, gPixels, cByteCount, gExpected);
+        CHECK(std::memcmp(gEncoded, gExpected, size) == 0);
+    }
+    // Random frames survive a round trip.
+    Random random;
+    for (uint16_t frame = 0; frame < 1000; ++frame) {
+        random.fill(gPixels, cByteCount);
+        NeoPixelEncoder::encode(encoding, gPixels, cByteCount, gEncoded);
+        uint8_t decoded[cByteCount];
+        CHECK(decode(encoding, gEncoded, cByteCount, decoded));
+        CHECK(std::memcmp(decoded, gPixels, cByteCount) == 0);
+    }
+    // The frame ends with at least 280 microseconds low level.
+    const size_t resetSize = NeoPixelEncoder::getResetSize(encoding);
+    CHECK(resetSize * 8 * 1000000ull / NeoPixelEncoder::getSpiClock(encoding) >= 280);
+    for (size_t i = size - resetSize; i < size; ++i) {
+        CHECK(gEncoded[i] == 0);
+    }
+}
+
+
+void checkTiming()
+{
+    // The NeoPixel bit is 1.25 microseconds +-600 ns, the short pulse 0.2-0.5 microseconds.
+    const Encoding encodings[] = {Encoding::ThreeBit, Encoding::FourBit};
+    for (Encoding encoding : encodings) {
+        const uint32_t spiClock = NeoPixelEncoder::getSpiClock(encoding);
+        const uint32_t bitTime = static_cast<uint32_t>(encoding) * 1000000000ul / spiClock;
+        const uint32_t pulseTime = 1000000000ul / spiClock;
+        CHECK(bitTime >= 650 && bitTime <= 1850);
+        CHECK(pulseTime >= 200 && pulseTime <= 500);
+    }
+}
+
+
+void benchmarkEncoding(Encoding encoding)
+{
+    Random random;
+    random.fill(gPixels, cByteCount);
+    const double time = test::measure(100000, [encoding](uint32_t) {
+        test::keep(NeoPixelEncoder::encode(encoding, gPixels, cByteCount, gEncoded));
+        test::keep(gEncoded);
+    });
+    std::printf("Encode %u bit: %.2f ns per pixel byte\n",
+        static_cast<unsigned>(encoding), time / cByteCount);
+}
+
+
+}
+
+
+int main()
+{
+    checkEncoding(Encoding::ThreeBit);
+    checkEncoding(Encoding::FourBit);
+    checkTiming();
+    benchmarkEncoding(Encoding::ThreeBit);
+    benchmarkEncoding(Encoding::FourBit);
+    return test::finish();
+}
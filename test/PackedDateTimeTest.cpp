@@ -0,0 +1,77 @@
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Test.hpp"
+
+#include "DateTime.hpp"
+#include "PackedDateTime.hpp"
+
+
+/// @file
+/// Checks the packed date/time.
+
+
+namespace {
+
+
+using lr::DateTime;
+using lr::PackedDateTime;
+
+
+void checkRoundTrip()
+{
+    const uint32_t lastSecond = DateTime(2063, 12, 31, 23, 59, 59).toSecondsSince2000();
+    PackedDateTime previous;
+    for (uint32_t seconds = 0; seconds <= lastSecond; seconds += 997) {
+        const DateTime dateTime = DateTime::fromSecondsSince2000(seconds);
+        PackedDateTime packed;
+        CHECK(PackedDateTime::fromDateTime(dateTime, packed));
+        CHECK(packed.toDateTime() == dateTime);
+        CHECK(packed.toDateTime().getDayOfWeek() == dateTime.getDayOfWeek());
+        CHECK(PackedDateTime::fromValue(packed.getValue()) == packed);
+        // The order of the packed values is the order of the date/times.
+        CHECK(seconds == 0 || previous < packed);
+        previous = packed;
+    }
+}
+
+
+void checkRange()
+{
+    PackedDateTime packed;
+    CHECK(PackedDateTime::fromDateTime(DateTime(2063, 12, 31, 23, 59, 59), packed));
+    CHECK(packed.getYear() == PackedDateTime::cLastYear);
+    CHECK(packed.getSecond() == 59);
+    // A later date/time fails and keeps the previous value.
+    const PackedDateTime before = packed;
+    CHECK(!PackedDateTime::fromDateTime(DateTime(2064, 1, 1), packed));
+    CHECK(packed == before);
+    CHECK(!PackedDateTime::fromDateTime(DateTime(9999, 12, 31, 23, 59, 59), packed));
+    CHECK(packed == before);
+    CHECK(PackedDateTime().toDateTime() == DateTime(2000, 1, 1));
+}
+
+
+}
+
+
+int main()
+{
+    checkRoundTrip();
+    checkRange();
+    return test::finish();
+}
@@ -0,0 +1,197 @@
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Test.hpp"
+
+#include "DS3231.hpp"
+#include "I2cBus.hpp"
+#include "MockDS3231Bus.hpp"
+
+#include <cstring>
+
+
+/// @file
+/// Checks the decoding and the binary format of the register snapshot.
+
+
+namespace {
+
+
+using lr::DateTime;
+using lr::MockDS3231Bus;
+namespace DS3231 = lr::DS3231;
+using DS3231::AlarmMode;
+using DS3231::AlarmValues;
+using DS3231::Register;
+using DS3231::RegisterSnapshot;
+
+
+/// A bus where every transfer fails.
+///
+class DeadBus : public lr::I2cBus
+{
+public:
+    bool writeRegisters(uint8_t, uint8_t, const uint8_t*, uint8_t) override {
+        return false;
+    }
+
+    bool readRegisters(uint8_t, uint8_t, uint8_t*, uint8_t) override {
+        return false;
+    }
+};
+
+
+bool isEqual(const AlarmValues &values, AlarmMode mode, uint8_t dayDate, uint8_t hour, uint8_t minute, uint8_t second)
+{
+    return values.mode == mode && values.dayDate == dayDate && values.hour == hour
+        && values.minute == minute && values.second == second;
+}
+
+
+/// Decode alarm 1 in every mode, as written by the driver.
+///
+void checkAlarm1()
+{
+    MockDS3231Bus bus;
+    DS3231::initialize(bus);
+    const AlarmMode modes[] = {
+        AlarmMode::EverySecond, AlarmMode::Second, AlarmMode::MinuteSecond,
+        AlarmMode::HourMinuteSecond, AlarmMode::DateHourMinuteSecond, AlarmMode::DayOfWeekHourMinuteSecond};
+    for (AlarmMode mode : modes) {
+        // 2020-06-21 is a Sunday.
+        CHECK(DS3231::setAlarm(DateTime(2020, 6, 21, 6, 7, 8), mode));
+        RegisterSnapshot snapshot;
+        CHECK(DS3231::readSnapshot(snapshot));
+        const uint8_t dayDate = (mode == AlarmMode::DayOfWeekHourMinuteSecond) ? 0 : 21;
+        CHECK(isEqual(snapshot.getAlarm1(), mode, dayDate, 6, 7, 8));
+    }
+}
+
+
+/// The encoding of alarm 2 and the expected values.
+///
+struct Alarm2Encoding {
+    uint8_t registers[3]; ///< The minutes, hours and day/date registers.
+    AlarmMode mode; ///< The expected mode.
+    uint8_t dayDate; ///< The expected day/date.
+};
+
+const Alarm2Encoding cAlarm2Encodings[] = {
+    {{0x87, 0x86, 0x80}, AlarmMode::Second, 0}, // Every minute, A2M2-A2M4 set.
+    {{0x07, 0x86, 0x80}, AlarmMode::MinuteSecond, 0}, // A2M3 and A2M4 set.
+    {{0x07, 0x06, 0x80}, AlarmMode::HourMinuteSecond, 0}, // A2M4 set.
+    {{0x07, 0x06, 0x21}, AlarmMode::DateHourMinuteSecond, 21},
+    {{0x07, 0x06, 0x47}, AlarmMode::DayOfWeekHourMinuteSecond, 0}, // DY set, Sunday.
+    {{0x07, 0x06, 0x43}, AlarmMode::DayOfWeekHourMinuteSecond, 3}, // DY set, Wednesday.
+};
+
+
+/// Decode alarm 2, which has no seconds register.
+///
+void checkAlarm2()
+{
+    for (const Alarm2Encoding &encoding : cAlarm2Encodings) {
+        RegisterSnapshot snapshot;
+        std::memset(&snapshot, 0, sizeof(snapshot));
+        // The seconds of alarm 1 must not be used for alarm 2.
+        snapshot.registers[static_cast<uint8_t>(Register::Alarm1DayDate)] = 0x80;
+        std::memcpy(snapshot.registers + static_cast<uint8_t>(Register::Alarm2Minutes), encoding.registers, 3);
+        CHECK(isEqual(snapshot.getAlarm2(), encoding.mode, encoding.dayDate, 6, 7, 0));
+    }
+}
+
+
+/// The century bit in the month register adds 100 years to the year base.
+///
+void checkCentury()
+{
+    MockDS3231Bus bus;
+    DS3231::initialize(bus);
+    CHECK(DS3231::setDateTime(DateTime(2120, 6, 21, 19, 30, 15)));
+    RegisterSnapshot snapshot;
+    CHECK(DS3231::readSnapshot(snapshot));
+    CHECK((snapshot.getRegister(Register::MonthCentury) & 0x80) != 0);
+    CHECK(snapshot.getDateTime() == DateTime(2120, 6, 21, 19, 30, 15));
+    CHECK(DS3231::setDateTime(DateTime(2099, 12, 31, 23, 59, 59)));
+    CHECK(DS3231::readSnapshot(snapshot));
+    CHECK((snapshot.getRegister(Register::MonthCentury) & 0x80) == 0);
+    CHECK(snapshot.getDateTime() == DateTime(2099, 12, 31, 23, 59, 59));
+    // The year base is part of the snapshot.
+    snapshot.registers[static_cast<uint8_t>(Register::MonthCentury)] |= 0x80;
+    snapshot.yearBase = 2100;
+    CHECK(snapshot.getDateTime() == DateTime(2299, 12, 31, 23, 59, 59));
+}
+
+
+/// Serialize a snapshot and read it back, also with a wrong version and size.
+///
+void checkSerialization()
+{
+    MockDS3231Bus bus;
+    bus.registers[static_cast<uint8_t>(Register::AgingOffset)] = 0xfe;
+    bus.registers[static_cast<uint8_t>(Register::TemperatureHigh)] = 0x19;
+    bus.registers[static_cast<uint8_t>(Register::TemperatureLow)] = 0x40;
+    DS3231::initialize(bus);
+    CHECK(DS3231::setDateTime(DateTime(2120, 6, 21, 19, 30, 15)));
+    RegisterSnapshot snapshot;
+    CHECK(DS3231::readSnapshot(snapshot));
+    uint8_t data[RegisterSnapshot::cSerializedSize + 1];
+    CHECK(snapshot.serialize(data, RegisterSnapshot::cSerializedSize - 1) == 0);
+    CHECK(snapshot.serialize(data, sizeof(data)) == RegisterSnapshot::cSerializedSize);
+    CHECK(data[0] == RegisterSnapshot::cFormatVersion);
+    RegisterSnapshot restored;
+    CHECK(restored.deserialize(data, RegisterSnapshot::cSerializedSize));
+    CHECK(restored.yearBase == snapshot.yearBase);
+    CHECK(std::memcmp(restored.registers, snapshot.registers, RegisterSnapshot::cRegisterCount) == 0);
+    CHECK(restored.getDateTime() == DateTime(2120, 6, 21, 19, 30, 15));
+    CHECK(restored.getAgingOffset() == -2);
+    CHECK(restored.getTemperature() == 25.25f);
+    // A wrong size or version is rejected and does not change the snapshot.
+    RegisterSnapshot rejected;
+    std::memset(&rejected, 0, sizeof(rejected));
+    CHECK(!rejected.deserialize(data, RegisterSnapshot::cSerializedSize - 1));
+    CHECK(!rejected.deserialize(data, RegisterSnapshot::cSerializedSize + 1));
+    data[0] = RegisterSnapshot::cFormatVersion + 1;
+    CHECK(!rejected.deserialize(data, RegisterSnapshot::cSerializedSize));
+    CHECK(rejected.yearBase == 0 && rejected.registers[static_cast<uint8_t>(Register::Year)] == 0);
+}
+
+
+/// A failed read is reported.
+///
+void checkFailedRead()
+{
+    DeadBus bus;
+    DS3231::initialize(bus);
+    RegisterSnapshot snapshot;
+    CHECK(!DS3231::readSnapshot(snapshot));
+    CHECK(!DS3231::printAllRegisterValues());
+}
+
+
+}
+
+
+int main()
+{
+    checkAlarm1();
+    checkAlarm2();
+    checkCentury();
+    checkSerialization();
+    checkFailedRead();
+    return test::finish();
+}
@@ -0,0 +1,175 @@
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Test.hpp"
+
+#include "DS3231.hpp"
+#include "MockDS3231Bus.hpp"
+#include "RegisterRequest.hpp"
+#include "RequestQueue.hpp"
+
+
+/// @file
+/// Checks the queue for the background register transfers.
+
+
+namespace {
+
+
+using lr::DateTime;
+using lr::RegisterRequest;
+using lr::RequestQueue;
+namespace DS3231 = lr::DS3231;
+
+
+uint8_t gData[8];
+RegisterRequest *gOrder[16];
+uint8_t gOrderCount = 0;
+uint8_t gCallbackCount = 0;
+
+
+bool recordTransfer(RegisterRequest &request)
+{
+    gOrder[gOrderCount++] = &request;
+    return true;
+}
+
+
+void checkOrder()
+{
+    RequestQueue<3> queue;
+    RegisterRequest a(RegisterRequest::Type::Read, 0, gData, 1);
+    RegisterRequest b(RegisterRequest::Type::Write, 1, gData, 2);
+    RegisterRequest c(RegisterRequest::Type::Read, 2, gData, 3);
+    RegisterRequest d(RegisterRequest::Type::Read, 3, gData, 4);
+    CHECK(queue.isEmpty());
+    CHECK(queue.submit(a));
+    CHECK(!queue.submit(a)); // Already pending.
+    CHECK(queue.submit(b));
+    CHECK(queue.submit(c));
+    CHECK(!queue.submit(d)); // The queue is full.
+    CHECK(queue.getCount() == 3);
+    CHECK(a.isPending() && b.isPending() && c.isPending() && !d.isPending());
+    gOrderCount = 0;
+    CHECK(queue.processNext(recordTransfer));
+    CHECK(a.state == RegisterRequest::State::Done);
+    // Wrap around the ring buffer several times.
+    CHECK(queue.submit(d));
+    CHECK(queue.submit(a) == false); // Still full.
+    while (queue.processNext(recordTransfer)) {
+        if (gOrderCount < 10) {
+            queue.submit(*gOrder[gOrderCount - 1]);
+        }
+    }
+    CHECK(queue.isEmpty());
+    RegisterRequest * const expected[] = {&a, &b, &c, &d, &b, &c, &d, &b, &c, &d, &b, &c};
+    CHECK(gOrderCount == sizeof(expected) / sizeof(expected[0]));
+    for (uint8_t i = 0; i < gOrderCount; ++i) {
+        CHECK(gOrder[i] == expected[i]);
+    }
+    CHECK(!queue.processNext(recordTransfer));
+}
+
+
+/// A mocked chip where all reads fail.
+///
+class FailingBus : public lr::MockDS3231Bus
+{
+public:
+    bool readRegisters(uint8_t, uint8_t, uint8_t*, uint8_t) override {
+        return false;
+    }
+};
+
+
+void resubmitInCallback(RegisterRequest &request)
+{
+    ++gCallbackCount;
+    // The request is no longer pending in its callback.
+    CHECK(!request.isPending());
+    if (gCallbackCount < 3) {
+        CHECK(DS3231::submitRequest(request));
+    }
+}
+
+
+void checkDriverRequests()
+{
+    lr::MockDS3231Bus bus;
+    DS3231::initialize(bus);
+    CHECK(DS3231::setDateTime(DateTime(2020, 6, 21, 19, 30, 15)));
+    uint8_t time[DS3231::cDateTimeRegisterCount] = {};
+    RegisterRequest timeRequest(RegisterRequest::Type::Read,
+        static_cast<uint8_t>(DS3231::Register::Seconds), time, sizeof(time), resubmitInCallback);
+    uint8_t control = 0x05;
+    RegisterRequest controlRequest(RegisterRequest::Type::Write,
+        static_cast<uint8_t>(DS3231::Register::Control), &control, 1);
+    CHECK(DS3231::submitRequest(timeRequest));
+    CHECK(DS3231::submitRequest(controlRequest));
+    CHECK(DS3231::hasPendingRequests());
+    bus.resetCounters();
+    DS3231::processRequests();
+    // The resubmitted request is executed in the same call, after the write.
+    CHECK(gCallbackCount == 3);
+    CHECK(!DS3231::hasPendingRequests());
+    CHECK(bus.getTransactionCount() == 3 * 2 + 1);
+    CHECK(timeRequest.state == RegisterRequest::State::Done);
+    CHECK(controlRequest.state == RegisterRequest::State::Done);
+    CHECK(bus.registers[static_cast<uint8_t>(DS3231::Register::Control)] == 0x05);
+    CHECK(DS3231::convertDateTime(time) == DateTime(2020, 6, 21, 19, 30, 15));
+    // A failed transfer is reported to the callback.
+    FailingBus failingBus;
+    DS3231::initialize(failingBus);
+    gCallbackCount = 2;
+    CHECK(DS3231::submitRequest(timeRequest));
+    DS3231::processRequests();
+    CHECK(gCallbackCount == 3);
+    CHECK(timeRequest.state == RegisterRequest::State::Failed);
+}
+
+
+bool failTransfer(RegisterRequest&)
+{
+    return false;
+}
+
+
+void checkFailedTransfer()
+{
+    RequestQueue<2> queue;
+    RegisterRequest request(RegisterRequest::Type::Read, 0, gData, 1);
+    CHECK(queue.submit(request));
+    CHECK(queue.processNext(failTransfer));
+    CHECK(request.state == RegisterRequest::State::Failed);
+    CHECK(!request.isPending());
+    // A failed request can be submitted again.
+    CHECK(queue.submit(request));
+    CHECK(queue.processNext(recordTransfer));
+    CHECK(request.state == RegisterRequest::State::Done);
+}
+
+
+}
+
+
+int main()
+{
+    checkOrder();
+    checkDriverRequests();
+    checkFailedTransfer();
+    return test::finish();
+}
@@ -0,0 +1,152 @@
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Test.hpp"
+
+#include "DateTime.hpp"
+#include "Schedule.hpp"
+
+#include <vector>
+
+
+/// @file
+/// Compares the schedule minute by minute with hand written logic.
+
+
+namespace {
+
+
+using lr::DateTime;
+using lr::Schedule;
+using lr::ScheduleRule;
+
+
+/// The default rules of the firmware.
+///
+const ScheduleRule cDefaultRules[] = {
+    {ScheduleRule::cEveryDay, 101, 1231, ScheduleRule::time(19), ScheduleRule::time(24), ScheduleRule::Action::On},
+    {ScheduleRule::cEveryDay, 101, 1231, ScheduleRule::time(6), ScheduleRule::time(8), ScheduleRule::Action::On},
+};
+
+/// Rules with time windows over midnight.
+///
+const ScheduleRule cNightRules[] = {
+    {ScheduleRule::cFriday|ScheduleRule::cSaturday, 101, 1231, ScheduleRule::time(22), ScheduleRule::time(2), ScheduleRule::Action::On},
+    {ScheduleRule::cEveryDay, 1231, 1231, ScheduleRule::time(20), ScheduleRule::time(3), ScheduleRule::Action::On},
+    {ScheduleRule::cEveryDay, 1224, 1226, ScheduleRule::time(0), ScheduleRule::time(24), ScheduleRule::Action::Off},
+};
+
+
+/// The logic of the former `isOnTime()` function.
+///
+bool isOnDefault(const DateTime &dateTime)
+{
+    const uint8_t hour = dateTime.getHour();
+    return (hour >= 19) || (hour > 5 && hour < 8);
+}
+
+
+/// The expected state of the rules with windows over midnight.
+///
+bool isOnNight(const DateTime &dateTime)
+{
+    const DateTime previous = dateTime.addDays(-1);
+    const uint16_t minute = ScheduleRule::time(dateTime.getHour(), dateTime.getMinute());
+    const uint16_t date = dateTime.getMonth() * 100 + dateTime.getDay();
+    const uint16_t previousDate = previous.getMonth() * 100 + previous.getDay();
+    if (date >= 1224 && date <= 1226) {
+        return false;
+    }
+    const uint8_t weekday = dateTime.getDayOfWeek();
+    const uint8_t previousWeekday = previous.getDayOfWeek();
+    if (minute >= ScheduleRule::time(22) && (weekday == 5 || weekday == 6)) {
+        return true;
+    }
+    if (minute < ScheduleRule::time(2) && (previousWeekday == 5 || previousWeekday == 6)) {
+        return true;
+    }
+    if (minute >= ScheduleRule::time(20) && date == 1231) {
+        return true;
+    }
+    return minute < ScheduleRule::time(3) && previousDate == 1231;
+}
+
+
+/// Compare the state and the next transition for every minute of a year.
+///
+void checkSchedule(const Schedule &schedule, bool (*isOnExpected)(const DateTime&), uint16_t year)
+{
+    // Two extra days, to find the next transition of the last minutes.
+    const DateTime first(year, 1, 1);
+    const uint32_t minuteCount = (DateTime(year + 1, 1, 1).toSecondsSince2000() - first.toSecondsSince2000()) / 60;
+    const uint32_t totalCount = minuteCount + 2 * 1440;
+    std::vector<bool> states(totalCount);
+    DateTime dateTime = first;
+    for (uint32_t i = 0; i < totalCount; ++i) {
+        states[i] = isOnExpected(dateTime);
+        dateTime.advanceMinutes(1);
+    }
+    // The index of the next change of the state, searched backwards.
+    std::vector<uint32_t> nextChange(totalCount, totalCount);
+    for (uint32_t i = totalCount - 1; i > 0; --i) {
+        nextChange[i - 1] = (states[i] != states[i - 1]) ? i : nextChange[i];
+    }
+    dateTime = first;
+    for (uint32_t i = 0; i < minuteCount; ++i) {
+        CHECK(schedule.isOn(dateTime) == states[i]);
+        CHECK(nextChange[i] < totalCount);
+        CHECK(schedule.nextTransition(dateTime) == first.addSeconds(static_cast<int32_t>(nextChange[i]) * 60));
+        dateTime.advanceMinutes(1);
+    }
+}
+
+
+/// Check a few known times of the rules over midnight.
+///
+void checkNightWindows()
+{
+    const Schedule schedule(cNightRules, sizeof(cNightRules)/sizeof(ScheduleRule));
+    // 2020-01-03 is a Friday.
+    CHECK(!schedule.isOn(DateTime(2020, 1, 3, 21, 59, 0)));
+    CHECK(schedule.isOn(DateTime(2020, 1, 3, 22, 0, 0)));
+    CHECK(schedule.isOn(DateTime(2020, 1, 4, 1, 59, 0)));
+    CHECK(!schedule.isOn(DateTime(2020, 1, 4, 2, 0, 0)));
+    CHECK(schedule.nextTransition(DateTime(2020, 1, 3, 23, 0, 0)) == DateTime(2020, 1, 4, 2, 0, 0));
+    // Saturday night ends on Sunday, the Thursday night is off.
+    CHECK(schedule.isOn(DateTime(2020, 1, 5, 1, 0, 0)));
+    CHECK(!schedule.isOn(DateTime(2020, 1, 3, 1, 0, 0)));
+    // The new year's eve wraps over the end of the date range and the year.
+    CHECK(schedule.isOn(DateTime(2020, 1, 1, 2, 59, 0)));
+    CHECK(schedule.nextTransition(DateTime(2020, 12, 31, 19, 0, 0)) == DateTime(2020, 12, 31, 20, 0, 0));
+    CHECK(schedule.nextTransition(DateTime(2020, 12, 31, 20, 0, 0)) == DateTime(2021, 1, 1, 3, 0, 0));
+}
+
+
+}
+
+
+int main()
+{
+    const Schedule defaultSchedule(cDefaultRules, sizeof(cDefaultRules)/sizeof(ScheduleRule));
+    checkSchedule(defaultSchedule, &isOnDefault, 2020);
+    checkSchedule(defaultSchedule, &isOnDefault, 2021);
+    const Schedule nightSchedule(cNightRules, sizeof(cNightRules)/sizeof(ScheduleRule));
+    checkSchedule(nightSchedule, &isOnNight, 2020);
+    checkSchedule(nightSchedule, &isOnNight, 2021);
+    checkNightWindows();
+    return test::finish();
+}
@@ -0,0 +1,104 @@
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Test.hpp"
+
+#include "DateTime.hpp"
+#include "SolarTable.hpp"
+
+#include <cmath>
+#include <cstdlib>
+
+
+/// @file
+/// Compares every entry of the solar tables with a calculation using the math library.
+
+
+namespace {
+
+
+using lr::DateTime;
+
+
+/// The sunrise or sunset with the NOAA equations, calculated with libm.
+///
+uint16_t eventMinute(uint16_t dayOfYear, double latitude, double longitude, int16_t utcOffset, int8_t direction)
+{
+    const double pi = std::acos(-1.0);
+    const double year = 2.0 * pi / 365.0 * dayOfYear;
+    const double equationOfTime = 229.18 * (0.000075 + 0.001868 * std::cos(year) - 0.032077 * std::sin(year)
+        - 0.014615 * std::cos(2.0 * year) - 0.040849 * std::sin(2.0 * year));
+    const double declination = 0.006918 - 0.399912 * std::cos(year) + 0.070257 * std::sin(year)
+        - 0.006758 * std::cos(2.0 * year) + 0.000907 * std::sin(2.0 * year)
+        - 0.002697 * std::cos(3.0 * year) + 0.00148 * std::sin(3.0 * year);
+    const double latitudeRad = latitude * pi / 180.0;
+    double cosHourAngle = std::cos(90.833 * pi / 180.0) / (std::cos(latitudeRad) * std::cos(declination))
+        - std::tan(latitudeRad) * std::tan(declination);
+    cosHourAngle = std::fmin(1.0, std::fmax(-1.0, cosHourAngle));
+    const double hourAngle = std::acos(cosHourAngle) * 180.0 / pi;
+    const double minute = 720.0 - 4.0 * (longitude - direction * hourAngle) - equationOfTime + utcOffset;
+    return static_cast<uint16_t>(std::fmin(1439.0, std::fmax(0.0, std::round(minute))));
+}
+
+
+/// Check all entries of a table.
+///
+/// The compiler uses series for the trigonometric functions, so a value can
+/// round to the neighbouring minute. A difference of one minute is accepted.
+///
+template<int16_t tLatitude, int16_t tLongitude, int16_t tUtcOffset>
+void checkTable()
+{
+    typedef lr::SolarTable<tLatitude, tLongitude, tUtcOffset> Table;
+    for (uint16_t day = 0; day < 366; ++day) {
+        const uint16_t sunrise = eventMinute(day, tLatitude / 100.0, tLongitude / 100.0, tUtcOffset, -1);
+        const uint16_t sunset = eventMinute(day, tLatitude / 100.0, tLongitude / 100.0, tUtcOffset, 1);
+        CHECK(std::abs(Table::cSunrise[day] - sunrise) <= 1);
+        CHECK(std::abs(Table::cSunset[day] - sunset) <= 1);
+        CHECK(Table::cSunrise[day] <= Table::cSunset[day]);
+    }
+}
+
+
+/// Compare the table for Zurich with published times, in central european time.
+///
+void checkPublishedTimes()
+{
+    typedef lr::SolarTable<4737, 854, 60> Zurich;
+    const uint16_t summer = DateTime(2021, 6, 21).getDayOfYear();
+    const uint16_t winter = DateTime(2021, 12, 21).getDayOfYear();
+    CHECK(std::abs(Zurich::cSunrise[summer] - (4 * 60 + 29)) <= 3);
+    CHECK(std::abs(Zurich::cSunset[summer] - (20 * 60 + 26)) <= 3);
+    CHECK(std::abs(Zurich::cSunrise[winter] - (8 * 60 + 13)) <= 3);
+    CHECK(std::abs(Zurich::cSunset[winter] - (16 * 60 + 38)) <= 3);
+}
+
+
+}
+
+
+int main()
+{
+    checkTable<4737, 854, 60>(); // Zurich
+    checkTable<4071, -7401, -300>(); // New York
+    checkTable<-3387, 15121, 600>(); // Sydney
+    checkTable<0, 0, 0>(); // The equator
+    checkTable<6965, 1896, 60>(); // Tromsø, with polar night and polar day
+    checkTable<-7767, 16668, 720>(); // McMurdo Station
+    checkPublishedTimes();
+    return test::finish();
+}
@@ -0,0 +1,120 @@
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Test.hpp"
+
+#include "DateTime.hpp"
+#include "SystemClock.hpp"
+
+#include <cmath>
+#include <cstdlib>
+
+
+/// @file
+/// Simulates a drifting CPU clock and checks the drift measurement of the system clock.
+
+
+namespace {
+
+
+using lr::DateTime;
+using lr::SystemClock;
+
+
+/// The largest error of a drift measurement in parts per million.
+///
+/// The real time clock has a resolution of one second, so the measured time
+/// is up to one second off, over at least the minimum calibration time.
+///
+const int32_t cMaximumDriftError = static_cast<int32_t>(1000000000u / SystemClock::cMinimumCalibrationTime) + 1;
+
+
+/// Run the clock for 40 days, synchronized from a real time clock with one second resolution.
+///
+/// @param drift The drift of the CPU clock in ppm, positive if it is too slow.
+/// @param fraction The fraction of the second when the simulation starts.
+///
+void checkDrift(double drift, double fraction)
+{
+    SystemClock clock;
+    const double realStart = DateTime(2020, 1, 1).toSecondsSince2000() + fraction;
+    const uint32_t firstMilliseconds = 0xffff0000u; // The counter wraps after a minute.
+    uint32_t synchronizationCount = 0;
+    for (uint64_t realMilliseconds = 0; realMilliseconds < 40ull * 86400000; realMilliseconds += 1000) {
+        const double real = realStart + realMilliseconds / 1000.0;
+        const uint32_t rtcSeconds = static_cast<uint32_t>(std::floor(real));
+        const uint32_t milliseconds = firstMilliseconds + static_cast<uint32_t>(realMilliseconds * (1.0 - drift * 1e-6));
+        if (clock.isSynchronizationRequired(milliseconds)) {
+            clock.synchronize(DateTime::fromSecondsSince2000(rtcSeconds), milliseconds);
+            ++synchronizationCount;
+            // The first synchronization after the minimum calibration time measures the drift.
+            if (synchronizationCount > 2) {
+                CHECK(std::abs(clock.getDrift() - drift) <= cMaximumDriftError);
+            }
+        }
+        // After the first day, the extrapolated time stays within two seconds.
+        if (realMilliseconds >= 86400000) {
+            CHECK(std::abs(static_cast<int64_t>(clock.getSecondsSince2000(milliseconds)) - rtcSeconds) <= 2);
+        }
+        CHECK(clock.getDateTime(milliseconds).toSecondsSince2000() == clock.getSecondsSince2000(milliseconds));
+    }
+}
+
+
+/// A short calibration time does not measure the drift.
+///
+void checkShortCalibration()
+{
+    SystemClock clock;
+    clock.synchronize(DateTime(2020, 1, 1), 0);
+    // One second of rounding in ten minutes would be a drift of 1667 ppm.
+    clock.synchronize(DateTime(2020, 1, 1, 0, 10, 1), 600000);
+    CHECK(clock.getDrift() == 0);
+    clock.synchronize(DateTime(2020, 1, 1, 4, 0, 1), SystemClock::cMinimumCalibrationTime);
+    CHECK(clock.getDrift() > 0 && clock.getDrift() <= cMaximumDriftError);
+}
+
+
+/// A change of the real time clock restarts the calibration.
+///
+void checkTimeChange()
+{
+    SystemClock clock;
+    clock.synchronize(DateTime(2020, 1, 1), 0);
+    clock.synchronize(DateTime(2020, 1, 1, 1, 0, 0), 3600000);
+    clock.synchronize(DateTime(2021, 1, 1), 3700000);
+    CHECK(clock.getSecondsSince2000(3700000) == DateTime(2021, 1, 1).toSecondsSince2000());
+    CHECK(clock.getDrift() == 0);
+    CHECK(!clock.isSynchronizationRequired(3700000 + SystemClock::cDefaultSynchronizationInterval - 1));
+    CHECK(clock.isSynchronizationRequired(3700000 + SystemClock::cDefaultSynchronizationInterval));
+}
+
+
+}
+
+
+int main()
+{
+    for (double drift : {-4000.0, -250.0, 0.0, 37.0, 800.0, 2500.0}) {
+        for (double fraction : {0.0, 0.37, 0.99}) {
+            checkDrift(drift, fraction);
+        }
+    }
+    checkShortCalibration();
+    checkTimeChange();
+    return test::finish();
+}
@@ -0,0 +1,94 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+
+/// @file
+/// Minimal helpers for the host tests and benchmarks.
+
+
+namespace test {
+
+
+/// Get the number of failed checks.
+///
+inline uint32_t &getFailureCount()
+{
+    static uint32_t failureCount = 0;
+    return failureCount;
+}
+
+/// Record a failed check.
+///
+inline void fail(const char *file, int line, const char *expression)
+{
+    if (getFailureCount() < 20) {
+        std::printf("%s:%d: Check failed: %s\n", file, line, expression);
+    }
+    ++getFailureCount();
+}
+
+/// Print the result and get the exit code for the test.
+///
+inline int finish()
+{
+    if (getFailureCount() == 0) {
+        std::printf("All checks passed.\n");
+        return 0;
+    }
+    std::printf("%u checks failed.\n", static_cast<unsigned>(getFailureCount()));
+    return 1;
+}
+
+/// Keep a value alive, so the compiler does not remove the calculation.
+///
+template<typename tValue>
+inline void keep(const tValue &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/// Measure the time of a function in nanoseconds per iteration.
+///
+/// @param iterations The number of iterations.
+/// @param function A function `void(uint32_t iteration)`.
+///
+template<typename tFunction>
+inline double measure(uint32_t iterations, tFunction function)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        function(i);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+
+}
+
+
+/// Check a condition and record a failure.
+///
+#define CHECK(expression) \
+    do { if (!(expression)) { test::fail(__FILE__, __LINE__, #expression); } } while (false)
@@ -0,0 +1,149 @@
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+#include "Test.hpp"
+
+#include "DateTime.hpp"
+#include "TimeZone.hpp"
+
+
+/// @file
+/// Checks the daylight saving transitions and the conversions of the time zone.
+
+
+namespace {
+
+
+using lr::DateTime;
+using lr::DaylightSavingRule;
+using lr::TimeZone;
+
+typedef lr::TimeZoneTable<60, DaylightSavingRule::European> EuropeTable;
+typedef lr::TimeZoneTable<-300, DaylightSavingRule::NorthAmerican> AmericaTable;
+
+const TimeZone gEurope(EuropeTable::cStandardOffset, EuropeTable::cTransitions, EuropeTable::cTransitionCount);
+const TimeZone gAmerica(AmericaTable::cStandardOffset, AmericaTable::cTransitions, AmericaTable::cTransitionCount);
+
+
+/// Check the rules of the tables with the calendar.
+///
+void checkTables()
+{
+    for (uint8_t year = 0; year < 50; ++year) {
+        const DateTime euBegin = DateTime::fromSecondsSince2000(EuropeTable::cTransitions[year * 2]);
+        const DateTime euEnd = DateTime::fromSecondsSince2000(EuropeTable::cTransitions[year * 2 + 1]);
+        // The last Sunday in March and October, at 01:00 UTC.
+        CHECK(euBegin == DateTime(2020 + year, 3, euBegin.getDay(), 1, 0, 0));
+        CHECK(euBegin.getDayOfWeek() == 0 && euBegin.getDay() >= 25);
+        CHECK(euEnd == DateTime(2020 + year, 10, euEnd.getDay(), 1, 0, 0));
+        CHECK(euEnd.getDayOfWeek() == 0 && euEnd.getDay() >= 25);
+        const DateTime usBegin = DateTime::fromSecondsSince2000(AmericaTable::cTransitions[year * 2]);
+        const DateTime usEnd = DateTime::fromSecondsSince2000(AmericaTable::cTransitions[year * 2 + 1]);
+        // The second Sunday in March, at 02:00 EST, the first Sunday in November, at 02:00 EDT.
+        CHECK(usBegin == DateTime(2020 + year, 3, usBegin.getDay(), 7, 0, 0));
+        CHECK(usBegin.getDayOfWeek() == 0 && usBegin.getDay() >= 8 && usBegin.getDay() <= 14);
+        CHECK(usEnd == DateTime(2020 + year, 11, usEnd.getDay(), 6, 0, 0));
+        CHECK(usEnd.getDayOfWeek() == 0 && usEnd.getDay() <= 7);
+    }
+    // Known dates.
+    CHECK(EuropeTable::cTransitions[0] == DateTime(2020, 3, 29, 1, 0, 0).toSecondsSince2000());
+    CHECK(EuropeTable::cTransitions[1] == DateTime(2020, 10, 25, 1, 0, 0).toSecondsSince2000());
+    CHECK(AmericaTable::cTransitions[0] == DateTime(2020, 3, 8, 7, 0, 0).toSecondsSince2000());
+    CHECK(AmericaTable::cTransitions[1] == DateTime(2020, 11, 1, 6, 0, 0).toSecondsSince2000());
+}
+
+
+/// Compare the conversions with a linear search, every 15 minutes of the table.
+///
+template<typename tTable>
+void checkConversion(const TimeZone &timeZone)
+{
+    const int32_t standardOffset = static_cast<int32_t>(tTable::cStandardOffset) * 60;
+    const uint32_t first = DateTime(2020, 1, 1).toSecondsSince2000();
+    const uint32_t last = DateTime(2069, 12, 31).toSecondsSince2000();
+    for (uint32_t seconds = first; seconds < last; seconds += 900) {
+        bool isDaylightSaving = false;
+        for (uint8_t i = 0; i < tTable::cTransitionCount; ++i) {
+            if (tTable::cTransitions[i] <= seconds) {
+                isDaylightSaving = !isDaylightSaving;
+            }
+        }
+        const int32_t offset = standardOffset + (isDaylightSaving ? 3600 : 0);
+        const DateTime utc = DateTime::fromSecondsSince2000(seconds);
+        CHECK(timeZone.getOffset(seconds) == offset);
+        CHECK(timeZone.isDaylightSaving(utc) == isDaylightSaving);
+        const DateTime local = timeZone.toLocal(utc);
+        CHECK(local.toSecondsSince2000() == seconds + offset);
+        // The repeated hour converts back to its first occurrence.
+        const uint32_t back = timeZone.toUtc(local).toSecondsSince2000();
+        CHECK(back == seconds || (!isDaylightSaving && back == seconds - 3600));
+        // Converting after the time before gives back this time.
+        CHECK(timeZone.toUtcAfter(local, utc.addSeconds(-1)) == utc);
+    }
+}
+
+
+/// The repeated and the skipped hour.
+///
+void checkTransitions()
+{
+    // 2020-10-25 02:30 local exists at 00:30 and at 01:30 UTC.
+    const DateTime repeated(2020, 10, 25, 2, 30, 0);
+    CHECK(gEurope.toUtc(repeated) == DateTime(2020, 10, 25, 0, 30, 0));
+    CHECK(gEurope.toUtcAfter(repeated, DateTime(2020, 10, 25, 0, 0, 0)) == DateTime(2020, 10, 25, 0, 30, 0));
+    CHECK(gEurope.toUtcAfter(repeated, DateTime(2020, 10, 25, 0, 30, 0)) == DateTime(2020, 10, 25, 1, 30, 0));
+    CHECK(gEurope.toUtcAfter(repeated, DateTime(2020, 10, 25, 1, 0, 0)) == DateTime(2020, 10, 25, 1, 30, 0));
+    // Both are in the past.
+    CHECK(gEurope.toUtcAfter(repeated, DateTime(2020, 10, 25, 2, 0, 0)) == DateTime(2020, 10, 25, 0, 30, 0));
+    // 2020-03-29 02:30 local does not exist and is read as standard time.
+    const DateTime skipped(2020, 3, 29, 2, 30, 0);
+    CHECK(gEurope.toUtc(skipped) == DateTime(2020, 3, 29, 1, 30, 0));
+    CHECK(gEurope.toUtcAfter(skipped, DateTime(2020, 3, 29, 0, 0, 0)) == DateTime(2020, 3, 29, 1, 30, 0));
+    // The next transitions.
+    CHECK(gEurope.getNextTransition(DateTime(2020, 5, 1)) == EuropeTable::cTransitions[1]);
+    CHECK(gEurope.getNextTransition(DateTime(2020, 10, 25, 1, 0, 0)) == EuropeTable::cTransitions[2]);
+    CHECK(gEurope.getNextTransition(DateTime(2070, 1, 1)) == 0xffffffffu);
+    // A time zone without daylight saving time.
+    const TimeZone fixed(330);
+    CHECK(fixed.getOffset(EuropeTable::cTransitions[0]) == 330 * 60);
+    CHECK(fixed.toUtc(DateTime(2020, 6, 1, 5, 30, 0)) == DateTime(2020, 6, 1, 0, 0, 0));
+    CHECK(fixed.getNextTransition(DateTime(2020, 6, 1)) == 0xffffffffu);
+}
+
+
+void benchmarkConversion()
+{
+    const uint32_t first = DateTime(2020, 1, 1).toSecondsSince2000();
+    const double time = test::measure(1000000, [first](uint32_t i) {
+        test::keep(gEurope.toLocal(DateTime::fromSecondsSince2000(first + i * 1597u)));
+    });
+    std::printf("fromSecondsSince2000 and toLocal: %.1f ns\n", time);
+}
+
+
+}
+
+
+int main()
+{
+    checkTables();
+    checkConversion<EuropeTable>(gEurope);
+    checkConversion<AmericaTable>(gAmerica);
+    checkTransitions();
+    benchmarkConversion();
+    return test::finish();
+}
@@ -0,0 +1,54 @@
+#pragma once
+//
+// (c)2019 by Lucky Resistor. See LICENSE for details.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+/// @file
+/// A minimal stub of the Arduino core, to build the firmware classes on the host.
+
+
+/// The string class of the Arduino core.
+///
+class String
+{
+public:
+    String(const char *text) : _text(text) {}
+    const char* c_str() const { return _text.c_str(); }
+    bool operator==(const char *text) const { return _text == text; }
+
+private:
+    std::string _text;
+};
+
+
+/// The serial interface, the output is discarded.
+///
+struct SerialStub
+{
+    void print(const char*) {}
+    void print(char) {}
+    void println(const char*) {}
+    void println() {}
+};
+
+extern SerialStub Serial;